@@ -0,0 +1,77 @@
+#include "headers/aggregation.h"
+
+#include <algorithm>
+#include <tuple>
+
+DemandAggregation::DemandAggregation(const std::vector<TrafficDemand> &demands, size_t lightpath_bandwidth)
+        : m_(demands.size()) {
+    // Groups are formed by sorting, the largest demands of a group first so that first-fit packs them well
+    std::vector<size_t> order(m_);
+    for (size_t demand_id = 0; demand_id < m_; ++demand_id) {
+        order[demand_id] = demand_id;
+    }
+    std::sort(order.begin(), order.end(), [&demands](size_t left, size_t right) {
+        return std::make_tuple(demands[left].source, demands[left].destination, demands[right].bandwidth, left) <
+               std::make_tuple(demands[right].source, demands[right].destination, demands[left].bandwidth, right);
+    });
+
+    std::vector<std::vector<size_t>> bins;
+    std::vector<size_t> bins_bandwidth;
+    members_offsets_.push_back(0);
+    members_.reserve(m_);
+    for (size_t begin = 0, end = 0; begin < m_; begin = end) {
+        const TrafficDemand &first = demands[order[begin]];
+        end = begin + 1;
+        while (end < m_ && demands[order[end]].source == first.source &&
+               demands[order[end]].destination == first.destination) {
+            ++end;
+        }
+
+        bins.clear();
+        bins_bandwidth.clear();
+        for (size_t i = begin; i < end; ++i) {
+            size_t demand_id = order[i];
+            size_t bin = 0;
+            while (bin < bins.size() && bins_bandwidth[bin] + demands[demand_id].bandwidth > lightpath_bandwidth) {
+                ++bin;
+            }
+            if (bin == bins.size()) {
+                bins.emplace_back();
+                bins_bandwidth.push_back(0);
+            }
+            bins[bin].push_back(demand_id);
+            bins_bandwidth[bin] += demands[demand_id].bandwidth;
+        }
+
+        for (size_t bin = 0; bin < bins.size(); ++bin) {
+            aggregates_.emplace_back(first.source, first.destination, bins_bandwidth[bin]);
+            members_.insert(members_.end(), bins[bin].begin(), bins[bin].end());
+            members_offsets_.push_back(members_.size());
+        }
+    }
+}
+
+const std::vector<TrafficDemand> &DemandAggregation::GetAggregates() const {
+    return aggregates_;
+}
+
+Solution DemandAggregation::Expand(const Solution &aggregates_solution) const {
+    Solution solution = aggregates_solution;
+    solution.demand_lightpaths.assign(m_, {});
+    for (std::vector<size_t> &demands: solution.lightpath_demands) {
+        demands.clear();
+    }
+
+    for (size_t aggregate_id = 0; aggregate_id < aggregates_.size(); ++aggregate_id) {
+        const std::vector<size_t> &path = aggregates_solution.demand_lightpaths[aggregate_id];
+        for (size_t i = members_offsets_[aggregate_id]; i < members_offsets_[aggregate_id + 1]; ++i) {
+            size_t demand_id = members_[i];
+            solution.demand_lightpaths[demand_id] = path;
+            for (size_t lp_id: path) {
+                solution.lightpath_demands[lp_id].push_back(demand_id);
+            }
+        }
+    }
+
+    return solution;
+}
@@ -1,188 +1,906 @@
 #include "headers/algorithm.h"
+#include "headers/solution_file.h"
+#include "headers/trace.h"
 
 #include <algorithm>
 #include <queue>
+#include <random>
+#include <thread>
+#include <tuple>
+
+// Number of demands the two solutions route over different paths
+static size_t PathsDifference(const Solution &left, const Solution &right) {
+    size_t difference = 0;
+    for (size_t demand_id = 0; demand_id < left.demand_lightpaths.size(); ++demand_id) {
+        difference += left.demand_lightpaths[demand_id] != right.demand_lightpaths[demand_id];
+    }
+    return difference;
+}
 
 Algorithm::Algorithm(size_t n, size_t m, size_t lightpath_bandwidth, const std::vector<TrafficDemand> &traffic_demands,
-                     const Graph &network)
+                     const Graph &network, size_t seed)
         : n_(n), lightpath_bandwidth_(lightpath_bandwidth), network_(network), virtual_topology_(n),
-          is_path_ok_([this](const std::vector<size_t> &path,
-                             size_t bandwidth) {
-              return HasEnoughBandwidth(path, bandwidth) && IsSimple(path);
-          }) {
-    traffic_demands_ptrs_.reserve(m);
+          traffic_demands_(traffic_demands), demands_order_(m), lower_bound_(n, lightpath_bandwidth, traffic_demands),
+          cur_solution_(n, m), feasible_path_(cur_solution_), relinking_start_topology_(n) {
+    cur_solution_.lightpaths_.reserve(m);
+    cur_solution_.unused_bandwidth.reserve(m);
     cur_solution_.use_of_lightpaths.reserve(m);
-    cur_solution_.demand_lightpaths.reserve(m);
     cur_solution_.lightpath_demands.reserve(m);
-    for (const TrafficDemand &demand: traffic_demands) {
-        cur_solution_.demand_lightpaths[&demand];
-        traffic_demands_ptrs_.push_back(&demand);
+    for (size_t demand_id = 0; demand_id < m; ++demand_id) {
+        demands_order_[demand_id] = demand_id;
+    }
+
+    // Seed 0 keeps the demands order as given, any other seed starts the chain from its own random order
+    if (seed != 0) {
+        std::mt19937 gen(seed);
+        std::shuffle(demands_order_.begin(), demands_order_.end(), gen);
+    }
+}
+
+Algorithm::Algorithm(size_t n, size_t m, size_t lightpath_bandwidth, const std::vector<TrafficDemand> &traffic_demands,
+                     const Graph &network, const Solution &previous_solution, size_t seed)
+        : Algorithm(n, m, lightpath_bandwidth, traffic_demands, network, seed) {
+    std::vector<size_t> nodes;
+    std::vector<size_t> new_lp_ids(previous_solution.lightpaths_.size(), SIZE_MAX);
+    for (size_t lp_id = 0; lp_id < previous_solution.lightpaths_.size(); ++lp_id) {
+        if (previous_solution.use_of_lightpaths[lp_id]) {
+            const size_t *lp_nodes = previous_solution.LightpathNodes(lp_id);
+            nodes.assign(lp_nodes, lp_nodes + previous_solution.lightpaths_[lp_id].nodes_number);
+
+            new_lp_ids[lp_id] = cur_solution_.AddLightpath(lightpath_bandwidth_, nodes);
+            virtual_topology_.AddEdge(nodes.front(), nodes.back(), new_lp_ids[lp_id]);
+        }
+    }
+
+    if (m != 0 && AdoptSolution(previous_solution, new_lp_ids)) {
+        best_solution_ = cur_solution_;
+        has_incumbent_ = true;
     }
 }
 
-Solution Algorithm::Run() {
+Algorithm::Algorithm(size_t n, size_t lightpath_bandwidth, const Graph &network)
+        : Algorithm(n, 0, lightpath_bandwidth, online_demands_, network) {
+}
+
+Solution Algorithm::Run(const RunConfig &config) {
+    auto start = std::chrono::steady_clock::now();
+    cancellation_token_ = config.cancellation_token;
+    deadline_ = std::chrono::steady_clock::time_point::max();
+    if (config.time_budget < deadline_ - start) {
+        deadline_ = start + config.time_budget;
+    }
+    interruptible_ = false;
+    stopped_ = false;
+    speculative_workers_ = std::max<size_t>(config.speculative_workers, 1);
+    StatsCounters stats_start = ThreadStatsCounters();
+    stats_ = SolverStats();
+
+    if (demands_changed_) {
+        lower_bound_.Update();
+        demands_changed_ = false;
+    }
+
     size_t no_changes_counter = 0;
     size_t min_lightpaths_number = SIZE_MAX;
-    while (no_changes_counter != 4) {
-        Construct();
-        LightpathMin();
+    elite_pool_.clear();
+    if (has_incumbent_) {
+        min_lightpaths_number = best_solution_.lightpaths_number_;
+        has_incumbent_ = false;
+        if (config.elite_pool_size != 0) {
+            elite_pool_.push_back(best_solution_);
+        }
+    }
+    auto is_optimal = [&]() {
+        return min_lightpaths_number <= std::max(config.target_lightpaths_number, lower_bound_.Get());
+    };
+
+    auto last_checkpoint = start;
+    bool is_checkpointed = true;
+    auto checkpoint = [&]() {
+        std::string error;
+        if (SaveSolution(config.checkpoint_path, best_solution_, error)) {
+            last_checkpoint = std::chrono::steady_clock::now();
+            is_checkpointed = true;
+        }
+    };
 
+    auto update_incumbent = [&]() {
+        if (cur_solution_.lightpaths_number_ >= min_lightpaths_number) {
+            return false;
+        }
+        best_solution_ = cur_solution_;
+        min_lightpaths_number = best_solution_.lightpaths_number_;
+        if (config.on_incumbent) {
+            config.on_incumbent(best_solution_);
+        }
+        is_checkpointed = false;
+        return true;
+    };
+
+    for (size_t iteration = 0; iteration < config.max_iterations &&
+                               no_changes_counter < config.max_no_changes_iterations && !is_optimal(); ++iteration) {
+        ScopedTrace trace("iteration", iteration);
+        if (!Construct()) {
+            break;
+        }
+        interruptible_ = true;
+        LightpathMin();
         size_t lightpaths_number = cur_solution_.lightpaths_number_;
-        if (lightpaths_number < min_lightpaths_number) {
-            best_solution_ = cur_solution_;
-            min_lightpaths_number = lightpaths_number;
+        bool is_improved = update_incumbent();
+
+        // The next iteration starts from the relinked solution only if it beats the local optimum, so that
+        // relinking never sets the search back
+        if (config.elite_pool_size != 0) {
+            UpdateElitePool(config.elite_pool_size);
+            const Solution *guide = ChooseGuide();
+            if (guide != nullptr && !is_optimal() && !ShouldStop()) {
+                relinking_start_ = cur_solution_;
+                relinking_start_topology_ = virtual_topology_;
+                if (RelinkTowards(*guide)) {
+                    LightpathMin();
+                }
+                if (cur_solution_.lightpaths_number_ < lightpaths_number) {
+                    lightpaths_number = cur_solution_.lightpaths_number_;
+                    is_improved = update_incumbent() || is_improved;
+                    UpdateElitePool(config.elite_pool_size);
+                } else {
+                    std::swap(cur_solution_, relinking_start_);
+                    std::swap(virtual_topology_, relinking_start_topology_);
+                }
+            }
+        }
+
+        stats_.iterations_lightpaths.push_back(lightpaths_number);
+        if (is_improved) {
             no_changes_counter = 0;
         } else {
             ++no_changes_counter;
         }
+
+        if (!is_checkpointed && !config.checkpoint_path.empty() &&
+            std::chrono::steady_clock::now() - last_checkpoint >= config.checkpoint_interval) {
+            checkpoint();
+        }
+
+        if (is_optimal() || ShouldStop()) {
+            break;
+        }
+    }
+
+    if (!is_checkpointed && !config.checkpoint_path.empty()) {
+        checkpoint();
+    }
+
+    if (min_lightpaths_number != SIZE_MAX) {
+        RestoreBestSolution();
+    }
+
+    if constexpr (kStatsEnabled) {
+        stats_.counters = ThreadStatsCounters();
+        stats_.counters -= stats_start;
+        stats_.counters.timers_ns[static_cast<size_t>(StatsTimer::kRun)] =
+                std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
     }
 
     return best_solution_;
 }
 
-void Algorithm::Construct() {
-    std::sort(traffic_demands_ptrs_.begin(), traffic_demands_ptrs_.end(),
-              [this](const TrafficDemand *left, const TrafficDemand *right) {
-                  return cur_solution_.demand_lightpaths[left].size() <
-                         cur_solution_.demand_lightpaths[right].size();
-              });
+const LowerBound &Algorithm::GetLowerBound() const {
+    return lower_bound_;
+}
+
+const SolverStats &Algorithm::GetStats() const {
+    return stats_;
+}
+
+bool Algorithm::IsOnline() const {
+    return &traffic_demands_ == &online_demands_;
+}
+
+size_t Algorithm::AddDemand(const TrafficDemand &demand) {
+    if (!IsOnline()) {
+        return SIZE_MAX;
+    }
+
+    interruptible_ = false;
+    stopped_ = false;
+
+    size_t demand_id = online_demands_.size();
+    online_demands_.push_back(demand);
+    cur_solution_.demand_lightpaths.emplace_back();
+    demands_order_.push_back(demand_id);
+    demands_changed_ = true;
+
+    RouteDemand(demand_id);
+    GroomLightpaths(cur_solution_.demand_lightpaths[demand_id]);
+
+    return demand_id;
+}
+
+bool Algorithm::RemoveDemand(size_t demand_id) {
+    if (!IsOnline() || demand_id >= online_demands_.size()) {
+        return false;
+    }
+
+    interruptible_ = false;
+    stopped_ = false;
+
+    size_t last_id = online_demands_.size() - 1;
+    std::vector<size_t> touched_lp_idxes = cur_solution_.demand_lightpaths[demand_id];
+    cur_solution_.Unassign(demand_id, online_demands_[demand_id].bandwidth);
+    if (demand_id != last_id) {
+        std::vector<size_t> path = cur_solution_.demand_lightpaths[last_id];
+        cur_solution_.Unassign(last_id, online_demands_[last_id].bandwidth);
+        online_demands_[demand_id] = online_demands_[last_id];
+        cur_solution_.Assign(demand_id, online_demands_[demand_id].bandwidth, path);
+    }
+    online_demands_.pop_back();
+    cur_solution_.demand_lightpaths.pop_back();
+    if (demand_id < nogoods_.size()) {
+        nogoods_[demand_id].clear();
+        if (last_id < nogoods_.size()) {
+            nogoods_[demand_id].swap(nogoods_[last_id]);
+        }
+        nogoods_.resize(std::min(nogoods_.size(), online_demands_.size()));
+    }
+    for (std::unique_ptr<Algorithm> &speculator: speculators_) {
+        speculator->ClearNogoods();
+    }
+    *std::find(demands_order_.begin(), demands_order_.end(), last_id) = demands_order_.back();
+    demands_order_.pop_back();
+    demands_changed_ = true;
+
+    GroomLightpaths(std::move(touched_lp_idxes));
+    return true;
+}
+
+const Solution &Algorithm::GetSolution() const {
+    return cur_solution_;
+}
+
+const std::vector<TrafficDemand> &Algorithm::GetDemands() const {
+    return traffic_demands_;
+}
+
+bool Algorithm::Construct() {
+    ScopedStatsTimer timer(StatsTimer::kConstruct);
+    ScopedTrace trace("construct");
+    std::sort(demands_order_.begin(), demands_order_.end(), [this](size_t left, size_t right) {
+        return cur_solution_.demand_lightpaths[left].size() < cur_solution_.demand_lightpaths[right].size();
+    });
 
     cur_solution_.Reset(lightpath_bandwidth_);
 
-    for (const TrafficDemand *demand: traffic_demands_ptrs_) {
-        std::vector<size_t> path = virtual_topology_.GetPathEdges(demand->source, demand->destination,
-                                                                  demand->bandwidth, is_path_ok_);
+    for (size_t demand_id: demands_order_) {
+        if (ShouldStop()) {
+            return false;
+        }
+        RouteDemand(demand_id);
+    }
 
-        if (path.empty()) {
-            size_t distance = network_.GetDistance(demand->source, demand->destination);
-            std::deque<size_t> nodes;
-
-            bool is_found = false;
-            size_t lp_id = cur_solution_.lightpaths_.size();
-            for (size_t node = 0; node < n_; ++node) {
-                size_t remaining_distance = network_.GetDistance(node, demand->destination);
-                if (remaining_distance < distance) {
-                    nodes.push_front(node);
-                    distance = remaining_distance;
-                } else {
-                    nodes.push_back(node);
-                }
-            }
+    return true;
+}
 
-            for (size_t node: nodes) {
-                virtual_topology_.AddEdge(node, demand->destination, lp_id);
-                cur_solution_.lightpaths_.emplace_back(lightpath_bandwidth_,
-                                                       network_.GetPathVertices(node, demand->destination));
-                path = virtual_topology_.GetPathEdges(demand->source, demand->destination, demand->bandwidth,
-                                                      is_path_ok_);
-                if (path.empty()) {
-                    cur_solution_.lightpaths_.pop_back();
-                    virtual_topology_.RemoveEdge(node, demand->destination, lp_id);
-                } else {
-                    is_found = true;
-                    break;
-                }
-            }
+void Algorithm::RouteDemand(size_t demand_id) {
+    const TrafficDemand &demand = traffic_demands_[demand_id];
+    std::vector<size_t> path = SearchPath(demand);
+
+    if (path.empty()) {
+        path = RouteOverNewLightpath(demand);
+    }
 
-            if (!is_found) {
-                cur_solution_.lightpaths_.emplace_back(lightpath_bandwidth_,
-                                                       network_.GetPathVertices(demand->source, demand->destination));
-                path.push_back(lp_id);
-                virtual_topology_.AddEdge(demand->source, demand->destination, lp_id);
+    cur_solution_.Assign(demand_id, demand.bandwidth, path);
+}
+
+std::vector<size_t> Algorithm::RouteOverNewLightpath(const TrafficDemand &demand) {
+    // One search finds a feasible path of lightpaths from the source to every node it can reach, and keeps the
+    // physical nodes of the path to every node in reach_masks_. As in FeasiblePathPolicy, only the first lightpath
+    // may be traversed from its destination, so every path found here is one the grooming search accepts too
+    size_t words = NodeMaskWords(n_);
+    reach_masks_.resize(n_ * words);
+    uint64_t *source_mask = reach_masks_.data() + demand.source * words;
+    std::fill(source_mask, source_mask + words, 0);
+    SetNode(source_mask, demand.source);
+    auto extend = [this, &demand, words](size_t vertex, size_t neighbour, size_t lp_id) {
+        if (cur_solution_.unused_bandwidth[lp_id] < demand.bandwidth) {
+            return false;
+        }
+        if (vertex != demand.source && cur_solution_.lightpaths_[lp_id].source != vertex) {
+            return false;
+        }
+        const uint64_t *mask = reach_masks_.data() + vertex * words;
+        const size_t *nodes = cur_solution_.LightpathNodes(lp_id);
+        size_t nodes_number = cur_solution_.lightpaths_[lp_id].nodes_number;
+        for (size_t i = 0; i < nodes_number; ++i) {
+            if (nodes[i] != vertex && HasNode(mask, nodes[i])) {
+                return false;
             }
         }
 
-        cur_solution_.Assign(demand, path);
+        uint64_t *neighbour_mask = reach_masks_.data() + neighbour * words;
+        std::copy(mask, mask + words, neighbour_mask);
+        for (size_t i = 0; i < nodes_number; ++i) {
+            SetNode(neighbour_mask, nodes[i]);
+        }
+        return true;
+    };
+    virtual_topology_.GetReachableVertices(demand.source, extend, reached_, parent_edges_);
+
+    // The new lightpath starts at the reached node closest to the destination whose shortest route to the
+    // destination keeps the path simple, the nearest one to the source among equally close ones. The source itself
+    // always qualifies. The destination is only reached if SearchPath was cut short by a stop, as a path over
+    // existing lightpaths would have been found by it otherwise
+    size_t best_node = demand.source;
+    size_t best_distance = network_.GetDistance(demand.source, demand.destination);
+    for (size_t node: reached_) {
+        if (node == demand.destination) {
+            best_node = node;
+            break;
+        }
+        size_t distance = network_.GetDistance(node, demand.destination);
+        if (distance >= best_distance) {
+            continue;
+        }
+
+        const uint64_t *mask = reach_masks_.data() + node * words;
+        network_.GetPathVertices(node, demand.destination, route_);
+        bool is_simple = std::none_of(route_.begin() + 1, route_.end(), [mask](size_t route_node) {
+            return HasNode(mask, route_node);
+        });
+        if (is_simple) {
+            best_node = node;
+            best_distance = distance;
+        }
     }
+
+    std::vector<size_t> path;
+    for (size_t node = best_node; node != demand.source;) {
+        size_t lp_id = parent_edges_[node];
+        const Lightpath &lightpath = cur_solution_.lightpaths_[lp_id];
+        path.push_back(lp_id);
+        node = lightpath.source == node ? lightpath.destination : lightpath.source;
+    }
+    std::reverse(path.begin(), path.end());
+
+    if (best_node != demand.destination) {
+        CountStat(StatsCounter::kNewLightpaths);
+        network_.GetPathVertices(best_node, demand.destination, route_);
+        size_t lp_id = cur_solution_.AddLightpath(lightpath_bandwidth_, route_);
+        virtual_topology_.AddEdge(best_node, demand.destination, lp_id);
+        path.push_back(lp_id);
+    }
+
+    return path;
 }
 
 void Algorithm::LightpathMin() {
-    Solution best_solution = cur_solution_;
-
+    ScopedStatsTimer timer(StatsTimer::kLightpathMin);
+    ScopedTrace trace("lightpath_min");
     std::vector<size_t> lp_idxes(cur_solution_.lightpaths_.size());
     for (size_t i = 0; i < lp_idxes.size(); ++i) {
         lp_idxes[i] = i;
     }
 
+    GroomLightpaths(std::move(lp_idxes));
+}
+
+void Algorithm::GroomLightpaths(std::vector<size_t> lp_idxes) {
+    ResizeNogoods();
+
     std::sort(lp_idxes.begin(), lp_idxes.end(), [this](size_t left, size_t right) {
-        return cur_solution_.lightpaths_[left].nodes.size() > cur_solution_.lightpaths_[right].nodes.size();
+        return cur_solution_.lightpaths_[left].nodes_number > cur_solution_.lightpaths_[right].nodes_number;
     });
 
+    if (speculative_workers_ > 1) {
+        SpeculativeGroomLightpaths(lp_idxes);
+        return;
+    }
+
     for (size_t lp_id: lp_idxes) {
+        if (ShouldStop()) {
+            break;
+        }
         if (cur_solution_.use_of_lightpaths[lp_id]) {
-            if (Grooming(lp_id)) {
-                best_solution = cur_solution_;
+            TryGrooming(lp_id);
+        }
+    }
+}
+
+void Algorithm::SpeculativeGroomLightpaths(const std::vector<size_t> &lp_idxes) {
+    while (speculators_.size() < speculative_workers_) {
+        speculators_.push_back(std::make_unique<Algorithm>(n_, traffic_demands_.size(), lightpath_bandwidth_,
+                                                           traffic_demands_, network_));
+    }
+    if (speculation_pool_ == nullptr || speculation_pool_->GetWorkersNumber() != speculative_workers_) {
+        speculation_pool_ = std::make_unique<WorkerPool>(speculative_workers_);
+    }
+    speculations_.resize(speculative_workers_);
+
+    // The solution may have changed since the last pass, so the speculators refresh their replicas
+    ++version_;
+
+    size_t next = 0;
+    while (!ShouldStop()) {
+        size_t begin = next;
+        size_t batch_size = 0;
+        for (; next < lp_idxes.size() && batch_size < speculative_workers_; ++next) {
+            if (cur_solution_.use_of_lightpaths[lp_idxes[next]]) {
+                speculations_[batch_size++].lp_id = lp_idxes[next];
+            }
+        }
+        if (batch_size == 0) {
+            break;
+        }
+
+        // The solution is the snapshot all speculators of the batch read, nothing writes it until they are done.
+        // The workers hand what they counted over to this thread, which the stats of the run are taken from
+        speculation_pool_->Run(batch_size, [this](size_t i) {
+            StatsCounters stats_start = ThreadStatsCounters();
+            speculators_[i]->Speculate(*this, speculations_[i].lp_id, speculations_[i]);
+            if constexpr (kStatsEnabled) {
+                speculations_[i].stats = ThreadStatsCounters();
+                speculations_[i].stats -= stats_start;
+            }
+        });
+        if constexpr (kStatsEnabled) {
+            for (size_t i = 1; i < batch_size; ++i) {
+                ThreadStatsCounters() += speculations_[i].stats;
+            }
+        }
+
+        // A speculation saw what a serial pass would, until a commit changes the solution or a nogood learned earlier
+        // in the batch concerns its demands and so changes their order. Such lightpaths are groomed again serially,
+        // and so are the lightpaths skipped as unused that a commit before them has given demands
+        bool is_changed = false;
+        std::vector<size_t> nogood_demands;
+        for (size_t position = begin, i = 0; position < next && !ShouldStop(); ++position) {
+            size_t lp_id = lp_idxes[position];
+            bool is_speculated = i < batch_size && speculations_[i].lp_id == lp_id;
+            const Speculation &speculation = speculations_[is_speculated ? i++ : 0];
+            if (!cur_solution_.use_of_lightpaths[lp_id]) {
+                continue;
+            }
+            const std::vector<size_t> &demands_through_lp = cur_solution_.lightpath_demands[lp_id];
+            bool is_stale = !is_speculated || is_changed ||
+                            std::any_of(demands_through_lp.begin(), demands_through_lp.end(),
+                                        [&nogood_demands](size_t demand_id) {
+                return std::find(nogood_demands.begin(), nogood_demands.end(), demand_id) != nogood_demands.end();
+            });
+            if (is_stale) {
+                std::vector<size_t> demands = demands_through_lp;
+                is_changed = TryGrooming(lp_id) || is_changed;
+                nogood_demands.insert(nogood_demands.end(), demands.begin(), demands.end());
             } else {
-                cur_solution_ = best_solution;
+                is_changed = CommitSpeculation(speculation);
+                nogood_demands.push_back(speculation.nogood_demand_id);
             }
         }
+        if (is_changed) {
+            ++version_;
+        }
     }
-
-    cur_solution_ = best_solution;
 }
 
-bool Algorithm::GroomDemand(std::vector<const TrafficDemand *> &demands, size_t demand_id) {
-    if (demand_id == demands.size()) {
+bool Algorithm::TryGrooming(size_t lp_id) {
+    cur_solution_.Checkpoint();
+    if (Grooming(lp_id)) {
+        cur_solution_.Commit();
         return true;
     }
+    cur_solution_.Rollback();
+    return false;
+}
+
+void Algorithm::Speculate(const Algorithm &origin, size_t lp_id, Speculation &speculation) {
+    // The replica is only copied again after the origin has changed, and every speculation is undone on it. As the
+    // lightpath stays in the virtual topology, the topology of the replica never changes
+    if (replica_version_ != origin.version_) {
+        cur_solution_ = origin.cur_solution_;
+        virtual_topology_ = origin.virtual_topology_;
+        replica_version_ = origin.version_;
+    }
+    cancellation_token_ = origin.cancellation_token_;
+    deadline_ = origin.deadline_;
+    interruptible_ = origin.interruptible_;
+    stopped_ = false;
+
+    // The nogoods of the demands are taken from the origin, so they keep its number of words
+    nogoods_.resize(origin.nogoods_.size());
+    nogood_words_ = origin.nogood_words_;
+    usable_lightpaths_.resize(nogood_words_);
 
-    const TrafficDemand *demand_ptr = demands[demand_id];
-    std::vector<size_t> path = virtual_topology_.GetPathEdges(demand_ptr->source, demand_ptr->destination,
-                                                              demand_ptr->bandwidth, is_path_ok_);
-    for (size_t lp_id: path) {
-        cur_solution_.lightpaths_[lp_id].unused_bandwidth -= demand_ptr->bandwidth;
+    // Moving the demands only reads the nogoods of these demands, which the origin does not write during a batch
+    std::vector<size_t> demands_through_lp = cur_solution_.lightpath_demands[lp_id];
+    for (size_t demand_id: demands_through_lp) {
+        nogoods_[demand_id] = origin.nogoods_[demand_id];
     }
-    if (!path.empty() && GroomDemand(demands, demand_id + 1)) {
-        for (size_t lp_id: path) {
-            cur_solution_.lightpaths_[lp_id].unused_bandwidth += demand_ptr->bandwidth;
+
+    cur_solution_.Checkpoint();
+    speculation.groomed = MoveDemandsOff(lp_id);
+    speculation.reroutes.clear();
+    speculation.nogood_demand_id = SIZE_MAX;
+    speculation.nogood.clear();
+    for (size_t demand_id: demands_through_lp) {
+        if (speculation.groomed) {
+            speculation.reroutes.emplace_back(demand_id, cur_solution_.demand_lightpaths[demand_id]);
+        } else if (nogoods_[demand_id].size() > origin.nogoods_[demand_id].size()) {
+            speculation.nogood_demand_id = demand_id;
+            speculation.nogood.assign(nogoods_[demand_id].begin() + origin.nogoods_[demand_id].size(),
+                                      nogoods_[demand_id].end());
         }
-        cur_solution_.Assign(demand_ptr, path);
-        return true;
+        nogoods_[demand_id].clear();
     }
-    for (size_t lp_id: path) {
-        cur_solution_.lightpaths_[lp_id].unused_bandwidth += demand_ptr->bandwidth;
+    cur_solution_.Rollback();
+}
+
+bool Algorithm::CommitSpeculation(const Speculation &speculation) {
+    if (!speculation.groomed) {
+        if (speculation.nogood_demand_id != SIZE_MAX) {
+            std::vector<uint64_t> &nogoods = nogoods_[speculation.nogood_demand_id];
+            nogoods.insert(nogoods.end(), speculation.nogood.begin(), speculation.nogood.end());
+        }
+        return false;
     }
 
-    return false;
+    size_t lp_id = speculation.lp_id;
+    std::vector<size_t> demands_through_lp = cur_solution_.lightpath_demands[lp_id];
+    for (size_t demand_id: demands_through_lp) {
+        cur_solution_.Unassign(demand_id, traffic_demands_[demand_id].bandwidth);
+    }
+    for (const auto &[demand_id, path]: speculation.reroutes) {
+        cur_solution_.Assign(demand_id, traffic_demands_[demand_id].bandwidth, path);
+    }
+    const Lightpath &lightpath = cur_solution_.lightpaths_[lp_id];
+    virtual_topology_.RemoveEdge(lightpath.source, lightpath.destination, lp_id);
+    return true;
 }
 
-bool Algorithm::Grooming(size_t lp_id) {
-    virtual_topology_.RemoveEdge(cur_solution_.lightpaths_[lp_id].nodes.front(),
-                                 cur_solution_.lightpaths_[lp_id].nodes.back(), lp_id);
-    std::vector<const TrafficDemand *> demands_through_lp(cur_solution_.lightpath_demands[lp_id].begin(),
-                                                          cur_solution_.lightpath_demands[lp_id].end());
-    for (const TrafficDemand *demand_ptr: demands_through_lp) {
-        cur_solution_.Unassign(demand_ptr);
+bool Algorithm::AdoptSolution(const Solution &solution, const std::vector<size_t> &lp_ids) {
+    if (solution.demand_lightpaths.size() != traffic_demands_.size()) {
+        return false;
     }
 
-    bool groomed = GroomDemand(demands_through_lp);
-    if (!groomed) {
-        virtual_topology_.AddEdge(cur_solution_.lightpaths_[lp_id].nodes.front(),
-                                  cur_solution_.lightpaths_[lp_id].nodes.back(), lp_id);
+    // Every path has to lead from the source to the destination of its demand over distinct physical nodes
+    std::vector<size_t> path;
+    std::vector<uint64_t> path_mask(NodeMaskWords(n_));
+    bool is_compatible = true;
+    for (size_t demand_id = 0; demand_id < traffic_demands_.size() && is_compatible; ++demand_id) {
+        const TrafficDemand &demand = traffic_demands_[demand_id];
+        std::fill(path_mask.begin(), path_mask.end(), 0);
+        SetNode(path_mask.data(), demand.source);
+        size_t node = demand.source;
+        path.clear();
+        for (size_t old_lp_id: solution.demand_lightpaths[demand_id]) {
+            size_t lp_id = old_lp_id < lp_ids.size() ? lp_ids[old_lp_id] : SIZE_MAX;
+            if (lp_id == SIZE_MAX || cur_solution_.unused_bandwidth[lp_id] < demand.bandwidth) {
+                is_compatible = false;
+                break;
+            }
+
+            const Lightpath &lightpath = cur_solution_.lightpaths_[lp_id];
+            size_t next_node = lightpath.source == node ? lightpath.destination : lightpath.source;
+            const size_t *nodes = cur_solution_.LightpathNodes(lp_id);
+            for (size_t i = 0; i < lightpath.nodes_number && is_compatible; ++i) {
+                is_compatible = nodes[i] == node || !HasNode(path_mask.data(), nodes[i]);
+                SetNode(path_mask.data(), nodes[i]);
+            }
+            if (!is_compatible || (lightpath.source != node && lightpath.destination != node)) {
+                is_compatible = false;
+                break;
+            }
+            node = next_node;
+            path.push_back(lp_id);
+        }
+        is_compatible = is_compatible && !path.empty() && node == demand.destination;
+        if (is_compatible) {
+            cur_solution_.Assign(demand_id, demand.bandwidth, path);
+        }
     }
 
-    return groomed;
+    if (!is_compatible) {
+        cur_solution_.Reset(lightpath_bandwidth_);
+        for (std::vector<size_t> &lightpaths_idxes: cur_solution_.demand_lightpaths) {
+            lightpaths_idxes.clear();
+        }
+    }
+    return is_compatible;
 }
 
-bool Algorithm::HasEnoughBandwidth(const std::vector<size_t> &path, size_t bandwidth) {
-    return std::all_of(path.begin(), path.end(),
-                       [this, bandwidth](size_t lp_id) {
-                           return cur_solution_.lightpaths_[lp_id].unused_bandwidth >= bandwidth;
-                       });
+void Algorithm::RestoreBestSolution() {
+    // The lightpaths created after the best solution are dropped, and their ids will be reused for other nodes
+    ClearNogoods();
+    cur_solution_ = best_solution_;
+    virtual_topology_ = Graph(n_);
+    for (size_t lp_id = 0; lp_id < cur_solution_.lightpaths_.size(); ++lp_id) {
+        if (cur_solution_.use_of_lightpaths[lp_id]) {
+            virtual_topology_.AddEdge(cur_solution_.lightpaths_[lp_id].source,
+                                      cur_solution_.lightpaths_[lp_id].destination, lp_id);
+        }
+    }
 }
 
-bool Algorithm::IsSimple(const std::vector<size_t> &path) {
-    std::unordered_set<size_t> nodes;
-    if (!path.empty()) {
-        nodes.insert(cur_solution_.lightpaths_[path[0]].nodes[0]);
+void Algorithm::UpdateElitePool(size_t capacity) {
+    size_t lightpaths_number = cur_solution_.lightpaths_number_;
+    size_t min_difference = std::max<size_t>(1, traffic_demands_.size() / kEliteDiversity);
+    bool is_best = true;
+    bool is_diverse = true;
+    size_t most_similar = SIZE_MAX;
+    size_t most_similar_difference = SIZE_MAX;
+    for (size_t i = 0; i < elite_pool_.size(); ++i) {
+        size_t difference = PathsDifference(cur_solution_, elite_pool_[i]);
+        if (difference == 0) {
+            return;
+        }
+        is_best = is_best && lightpaths_number < elite_pool_[i].lightpaths_number_;
+        is_diverse = is_diverse && difference >= min_difference;
+        if (elite_pool_[i].lightpaths_number_ >= lightpaths_number && difference < most_similar_difference) {
+            most_similar = i;
+            most_similar_difference = difference;
+        }
     }
-    for (size_t lp_id: path) {
-        for (size_t i = 1; i < cur_solution_.lightpaths_[lp_id].nodes.size(); ++i) {
-            if (!nodes.insert(cur_solution_.lightpaths_[lp_id].nodes[i]).second) {
-                return false;
+
+    if (!is_best && !is_diverse) {
+        return;
+    }
+    if (elite_pool_.size() < capacity) {
+        elite_pool_.push_back(cur_solution_);
+    } else if (most_similar != SIZE_MAX) {
+        elite_pool_[most_similar] = cur_solution_;
+    }
+}
+
+const Solution *Algorithm::ChooseGuide() const {
+    // A solution strictly between the two needs them to differ in at least two demands
+    const Solution *guide = nullptr;
+    size_t guide_difference = 0;
+    for (const Solution &member: elite_pool_) {
+        size_t difference = PathsDifference(cur_solution_, member);
+        if (difference > 1 && (guide == nullptr || member.lightpaths_number_ < guide->lightpaths_number_ ||
+                               (member.lightpaths_number_ == guide->lightpaths_number_ &&
+                                difference > guide_difference))) {
+            guide = &member;
+            guide_difference = difference;
+        }
+    }
+    return guide;
+}
+
+bool Algorithm::RelinkTowards(const Solution &guide) {
+    ScopedTrace trace("relinking");
+
+    // The guide was found earlier in this run, so its lightpath ids are ours, but grooming may have taken some of
+    // its lightpaths out of the virtual topology since
+    for (size_t lp_id = 0; lp_id < guide.lightpaths_.size(); ++lp_id) {
+        if (guide.use_of_lightpaths[lp_id] && !virtual_topology_.HasEdge(lp_id)) {
+            virtual_topology_.AddEdge(cur_solution_.lightpaths_[lp_id].source,
+                                      cur_solution_.lightpaths_[lp_id].destination, lp_id);
+        }
+    }
+
+    std::vector<size_t> closing;
+    for (size_t lp_id = 0; lp_id < cur_solution_.lightpaths_.size(); ++lp_id) {
+        if (cur_solution_.use_of_lightpaths[lp_id] &&
+            (lp_id >= guide.lightpaths_.size() || !guide.use_of_lightpaths[lp_id])) {
+            closing.push_back(lp_id);
+        }
+    }
+    size_t difference = PathsDifference(cur_solution_, guide);
+
+    // A moved demand only uses lightpaths of the guide, so it is never moved again. The moves are journaled, and
+    // the best prefix of them is replayed at the end
+    std::vector<size_t> moves;
+    std::vector<size_t> block;
+    std::vector<std::vector<size_t>> old_paths;
+    auto move_demands = [&](size_t lp_id) {
+        block = cur_solution_.lightpath_demands[lp_id];
+        old_paths.clear();
+        for (size_t demand_id: block) {
+            old_paths.push_back(cur_solution_.demand_lightpaths[demand_id]);
+            cur_solution_.Unassign(demand_id, traffic_demands_[demand_id].bandwidth);
+        }
+
+        size_t moved = 0;
+        for (; moved < block.size(); ++moved) {
+            size_t bandwidth = traffic_demands_[block[moved]].bandwidth;
+            const std::vector<size_t> &path = guide.demand_lightpaths[block[moved]];
+            if (std::any_of(path.begin(), path.end(), [this, bandwidth](size_t path_lp_id) {
+                    return cur_solution_.unused_bandwidth[path_lp_id] < bandwidth;
+                })) {
+                break;
             }
+            cur_solution_.Assign(block[moved], bandwidth, path);
         }
+        if (moved == block.size()) {
+            moves.insert(moves.end(), block.begin(), block.end());
+            return true;
+        }
+
+        for (size_t i = 0; i < moved; ++i) {
+            cur_solution_.Unassign(block[i], traffic_demands_[block[i]].bandwidth);
+        }
+        for (size_t i = 0; i < block.size(); ++i) {
+            cur_solution_.Assign(block[i], traffic_demands_[block[i]].bandwidth, old_paths[i]);
+        }
+        return false;
+    };
+
+    // The lightpaths with the fewest demands are closed first, and the ones that do not fit yet are retried once
+    // the others have freed their bandwidth
+    cur_solution_.Checkpoint();
+    size_t best_moves_number = 0;
+    size_t best_lightpaths_number = SIZE_MAX;
+    for (bool is_progress = true; is_progress && !ShouldStop();) {
+        std::sort(closing.begin(), closing.end(), [this](size_t left, size_t right) {
+            return cur_solution_.lightpath_demands[left].size() < cur_solution_.lightpath_demands[right].size();
+        });
+
+        size_t kept = 0;
+        for (size_t lp_id: closing) {
+            if (cur_solution_.use_of_lightpaths[lp_id] && !move_demands(lp_id)) {
+                closing[kept++] = lp_id;
+            } else if (moves.size() < difference && cur_solution_.lightpaths_number_ < best_lightpaths_number) {
+                best_moves_number = moves.size();
+                best_lightpaths_number = cur_solution_.lightpaths_number_;
+            }
+        }
+        is_progress = kept < closing.size();
+        closing.resize(kept);
+    }
+    cur_solution_.Rollback();
+
+    // All the demands of the prefix leave their paths before any takes its guide path, as moves of one lightpath
+    // may only fit together
+    for (size_t i = 0; i < best_moves_number; ++i) {
+        cur_solution_.Unassign(moves[i], traffic_demands_[moves[i]].bandwidth);
+    }
+    for (size_t i = 0; i < best_moves_number; ++i) {
+        cur_solution_.Assign(moves[i], traffic_demands_[moves[i]].bandwidth, guide.demand_lightpaths[moves[i]]);
+    }
+    return best_moves_number != 0;
+}
+
+bool Algorithm::RerouteDemands(std::vector<size_t> &demands) {
+    // Demands that already failed in this pass go first, then the ones with more bandwidth and longer routes. Ties
+    // are broken by id, so the order does not depend on the order the demands of a lightpath are kept in
+    std::sort(demands.begin(), demands.end(), [this](size_t left, size_t right) {
+        const TrafficDemand &left_demand = traffic_demands_[left];
+        const TrafficDemand &right_demand = traffic_demands_[right];
+        return std::make_tuple(!nogoods_[left].empty(), left_demand.bandwidth,
+                               network_.GetDistance(left_demand.source, left_demand.destination), left) >
+               std::make_tuple(!nogoods_[right].empty(), right_demand.bandwidth,
+                               network_.GetDistance(right_demand.source, right_demand.destination), right);
+    });
+
+    for (size_t demand_id: demands) {
+        if (ShouldStop() || IsNogood(demand_id)) {
+            return false;
+        }
+
+        const TrafficDemand &demand = traffic_demands_[demand_id];
+        std::vector<size_t> path = SearchPath(demand);
+        if (path.empty()) {
+            // A search cut short by a stop proves nothing
+            if (!stopped_) {
+                AddNogood(demand_id);
+            }
+            return false;
+        }
+        cur_solution_.Assign(demand_id, demand.bandwidth, path);
     }
 
     return true;
 }
+
+void Algorithm::FillUsableLightpaths(size_t bandwidth) {
+    std::fill(usable_lightpaths_.begin(), usable_lightpaths_.end(), 0);
+    for (size_t lp_id = 0; lp_id < cur_solution_.lightpaths_.size(); ++lp_id) {
+        if (cur_solution_.unused_bandwidth[lp_id] >= bandwidth && virtual_topology_.HasEdge(lp_id) &&
+            lp_id != groomed_lp_id_) {
+            SetNode(usable_lightpaths_.data(), lp_id);
+        }
+    }
+}
+
+bool Algorithm::IsNogood(size_t demand_id) {
+    const std::vector<uint64_t> &nogoods = nogoods_[demand_id];
+    if (nogoods.empty()) {
+        return false;
+    }
+
+    FillUsableLightpaths(traffic_demands_[demand_id].bandwidth);
+    for (size_t offset = 0; offset < nogoods.size(); offset += nogood_words_) {
+        if (IsSubset(usable_lightpaths_.data(), nogoods.data() + offset, nogood_words_)) {
+            CountStat(StatsCounter::kNogoodHits);
+            return true;
+        }
+    }
+    return false;
+}
+
+void Algorithm::ResizeNogoods() {
+    nogoods_.resize(traffic_demands_.size());
+
+    // New lightpaths are stored as unusable in the old nogoods, which keeps them sound
+    size_t words = NodeMaskWords(cur_solution_.lightpaths_.size());
+    if (words > nogood_words_) {
+        for (std::vector<uint64_t> &nogoods: nogoods_) {
+            std::vector<uint64_t> resized(nogoods.size() / std::max<size_t>(nogood_words_, 1) * words, 0);
+            for (size_t offset = 0, resized_offset = 0; offset < nogoods.size();
+                 offset += nogood_words_, resized_offset += words) {
+                std::copy(nogoods.begin() + offset, nogoods.begin() + offset + nogood_words_,
+                          resized.begin() + resized_offset);
+            }
+            nogoods = std::move(resized);
+        }
+        nogood_words_ = words;
+        usable_lightpaths_.resize(nogood_words_);
+    }
+}
+
+void Algorithm::ClearNogoods() {
+    for (std::vector<uint64_t> &nogoods: nogoods_) {
+        nogoods.clear();
+    }
+    for (std::unique_ptr<Algorithm> &speculator: speculators_) {
+        speculator->ClearNogoods();
+    }
+}
+
+void Algorithm::AddNogood(size_t demand_id) {
+    FillUsableLightpaths(traffic_demands_[demand_id].bandwidth);
+    nogoods_[demand_id].insert(nogoods_[demand_id].end(), usable_lightpaths_.begin(), usable_lightpaths_.end());
+}
+
+bool Algorithm::Grooming(size_t lp_id) {
+    if (!MoveDemandsOff(lp_id)) {
+        return false;
+    }
+    virtual_topology_.RemoveEdge(cur_solution_.lightpaths_[lp_id].source, cur_solution_.lightpaths_[lp_id].destination,
+                                 lp_id);
+    return true;
+}
+
+bool Algorithm::MoveDemandsOff(size_t lp_id) {
+    CountStat(StatsCounter::kGroomingAttempts);
+    ScopedTrace trace("grooming", lp_id);
+    std::vector<size_t> demands_through_lp = cur_solution_.lightpath_demands[lp_id];
+    for (size_t demand_id: demands_through_lp) {
+        cur_solution_.Unassign(demand_id, traffic_demands_[demand_id].bandwidth);
+    }
+
+    groomed_lp_id_ = lp_id;
+    bool groomed = RerouteDemands(demands_through_lp);
+    groomed_lp_id_ = SIZE_MAX;
+    CountStat(StatsCounter::kGroomingSuccesses, groomed);
+
+    return groomed;
+}
+
+std::vector<size_t> Algorithm::SearchPath(const TrafficDemand &demand) {
+    SearchPolicy policy{*this};
+    return virtual_topology_.GetPathEdges(demand.source, demand.destination, demand.bandwidth, policy);
+}
+
+bool Algorithm::PushLightpath(size_t lp_id, size_t bandwidth) {
+    if (lp_id == groomed_lp_id_) {
+        return false;
+    }
+    // Rejecting every edge once the run is stopped makes a long search unwind without exploring anything else
+    if ((++pushes_number_ % 1024 == 0 && ShouldStop()) || stopped_) {
+        return false;
+    }
+    return feasible_path_.Push(lp_id, bandwidth);
+}
+
+void Algorithm::PopLightpath(size_t lp_id) {
+    feasible_path_.Pop(lp_id);
+}
+
+bool Algorithm::ShouldStop() {
+    if (!stopped_ && interruptible_) {
+        stopped_ = (cancellation_token_ != nullptr && cancellation_token_->IsCancelled()) ||
+                   (deadline_ != std::chrono::steady_clock::time_point::max() &&
+                    std::chrono::steady_clock::now() >= deadline_);
+    }
+    return stopped_;
+}
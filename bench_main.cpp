@@ -0,0 +1,44 @@
+#include "headers/benchmark.h"
+
+#include <iostream>
+#include <string>
+
+// Usage: grasp4_bench [--warmup=N] [--repetitions=N] [--seed=N] [--filter=SUBSTRING] [--counters]
+int main(int argc, char **argv) {
+    size_t warmup_repetitions = 3;
+    size_t repetitions = 20;
+    size_t seed = 1;
+    bool use_counters = false;
+    std::string filter;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        auto value = [&argument](const std::string &option) {
+            return argument.substr(option.size());
+        };
+
+        if (argument.rfind("--warmup=", 0) == 0) {
+            warmup_repetitions = std::stoul(value("--warmup="));
+        } else if (argument.rfind("--repetitions=", 0) == 0) {
+            repetitions = std::stoul(value("--repetitions="));
+        } else if (argument.rfind("--seed=", 0) == 0) {
+            seed = std::stoul(value("--seed="));
+        } else if (argument.rfind("--filter=", 0) == 0) {
+            filter = value("--filter=");
+        } else if (argument == "--counters") {
+            use_counters = true;
+        } else {
+            std::cerr << "Unknown argument: " << argument << std::endl;
+            return 1;
+        }
+    }
+
+    Benchmark benchmark(warmup_repetitions, repetitions, use_counters, filter);
+    if (use_counters && !benchmark.HasCounters()) {
+        std::cerr << "Hardware counters are not available, running without them" << std::endl;
+    }
+    KernelBenchmarks::Run(benchmark, seed);
+    benchmark.PrintJson(std::cout, seed);
+
+    return 0;
+}
@@ -0,0 +1,232 @@
+#include "headers/benchmark.h"
+
+#include "headers/algorithm.h"
+#include "headers/generator.h"
+#include "headers/graph.h"
+#include "headers/validator.h"
+
+#include <random>
+#include <utility>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+PerfCounters::PerfCounters() {
+    std::fill(fds_, fds_ + kCountersNumber, -1);
+
+#ifdef __linux__
+    const uint64_t configs[kCountersNumber] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_CACHE_MISSES,
+                                               PERF_COUNT_HW_BRANCH_MISSES};
+    for (size_t counter = 0; counter < kCountersNumber; ++counter) {
+        perf_event_attr attr{};
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = configs[counter];
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fds_[counter] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+#endif
+}
+
+PerfCounters::~PerfCounters() {
+#ifdef __linux__
+    for (int fd: fds_) {
+        if (fd != -1) {
+            close(fd);
+        }
+    }
+#endif
+}
+
+bool PerfCounters::IsAvailable() const {
+    return std::all_of(fds_, fds_ + kCountersNumber, [](int fd) {
+        return fd != -1;
+    });
+}
+
+void PerfCounters::Start() {
+#ifdef __linux__
+    for (int fd: fds_) {
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+}
+
+void PerfCounters::Stop(uint64_t (&values)[kCountersNumber]) {
+    for (size_t counter = 0; counter < kCountersNumber; ++counter) {
+        values[counter] = 0;
+#ifdef __linux__
+        ioctl(fds_[counter], PERF_EVENT_IOC_DISABLE, 0);
+        if (read(fds_[counter], &values[counter], sizeof(values[counter])) != sizeof(values[counter])) {
+            values[counter] = 0;
+        }
+#endif
+    }
+}
+
+Benchmark::Benchmark(size_t warmup_repetitions, size_t repetitions, bool use_counters, std::string filter)
+        : warmup_repetitions_(warmup_repetitions), repetitions_(std::max<size_t>(repetitions, 1)),
+          use_counters_(use_counters), filter_(std::move(filter)) {
+}
+
+bool Benchmark::IsSelected(const std::string &name) const {
+    return name.find(filter_) != std::string::npos;
+}
+
+bool Benchmark::HasCounters() const {
+    return use_counters_ && counters_.IsAvailable();
+}
+
+void Benchmark::PrintJson(std::ostream &out, size_t seed) const {
+    auto counter = [&out](bool has_counters, double value) -> std::ostream & {
+        if (has_counters) {
+            return out << value;
+        }
+        return out << "null";
+    };
+
+    out << "{\n";
+    out << "  \"seed\": " << seed << ",\n";
+    out << "  \"warmup_repetitions\": " << warmup_repetitions_ << ",\n";
+    out << "  \"repetitions\": " << repetitions_ << ",\n";
+    out << "  \"counters\": " << (HasCounters() ? "true" : "false") << ",\n";
+    out << "  \"benchmarks\": [";
+    for (size_t i = 0; i < results_.size(); ++i) {
+        const BenchmarkResult &result = results_[i];
+        out << (i == 0 ? "\n" : ",\n");
+        out << "    {\"name\": \"" << result.name << "\", \"batch_size\": " << result.batch_size
+            << ", \"repetitions\": " << result.repetitions << ", \"min_ns\": " << result.min_ns
+            << ", \"median_ns\": " << result.median_ns << ", \"mean_ns\": " << result.mean_ns << ", \"cycles\": ";
+        counter(result.has_counters, result.cycles) << ", \"cache_misses\": ";
+        counter(result.has_counters, result.cache_misses) << ", \"branch_misses\": ";
+        counter(result.has_counters, result.branch_misses) << "}";
+    }
+    out << "\n  ]\n}" << std::endl;
+}
+
+void KernelBenchmarks::Run(Benchmark &benchmark, size_t seed) {
+    for (size_t n : {128, 512}) {
+        DistancesBenchmarks(benchmark, seed, n);
+    }
+    for (auto [n, m] : {std::pair<size_t, size_t>{20, 100}, std::pair<size_t, size_t>{40, 300}}) {
+        InstanceBenchmarks(benchmark, seed, n, m);
+    }
+}
+
+void KernelBenchmarks::DistancesBenchmarks(Benchmark &benchmark, size_t seed, size_t n) {
+    std::vector<std::vector<size_t>> adj_matrix(n, std::vector<size_t>(n, 0));
+    Generator generator(seed);
+    generator.GenerateGraph(n, adj_matrix);
+
+    // Distances are only calculated by the constructor, so the whole construction of a network is measured
+    const std::pair<const char *, DistancesAlgorithm> algorithms[] = {
+            {"floyd", DistancesAlgorithm::kFloyd},
+            {"bfs", DistancesAlgorithm::kBfs},
+            {"bit_parallel_bfs", DistancesAlgorithm::kBitParallelBfs},
+    };
+    for (auto [name, algorithm] : algorithms) {
+        benchmark.Run("graph/calculate_distances/" + std::string(name) + "/n=" + std::to_string(n), 1,
+                      [&](size_t) {
+                          Graph network(n, adj_matrix, algorithm);
+                          DoNotOptimize(network.GetDistance(0, n - 1));
+                      });
+    }
+
+    Graph network(n, adj_matrix);
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<size_t> nodes(0, n - 1);
+    std::vector<std::pair<size_t, size_t>> pairs(1024);
+    for (auto &[from, to]: pairs) {
+        from = nodes(gen);
+        to = nodes(gen);
+    }
+    std::vector<size_t> path;
+    benchmark.Run("graph/get_path_vertices/n=" + std::to_string(n), pairs.size(), [&](size_t i) {
+        network.GetPathVertices(pairs[i].first, pairs[i].second, path);
+        DoNotOptimize(path.size());
+    });
+}
+
+void KernelBenchmarks::InstanceBenchmarks(Benchmark &benchmark, size_t seed, size_t n, size_t m) {
+    size_t lightpath_bandwidth;
+    std::vector<std::vector<size_t>> adj_matrix(n, std::vector<size_t>(n, 0));
+    std::vector<TrafficDemand> demands(m);
+    Generator generator(seed);
+    generator.GenerateInput(n, m, lightpath_bandwidth, adj_matrix, demands);
+    Graph network(n, std::move(adj_matrix));
+
+    std::string suffix = "/n=" + std::to_string(n) + ",m=" + std::to_string(m);
+
+    benchmark.Run("algorithm/run" + suffix, 1, [&](size_t) {
+        Algorithm algorithm(n, m, lightpath_bandwidth, demands, network);
+        DoNotOptimize(algorithm.Run().lightpaths_number_);
+    });
+
+    // After Run() the solver holds its best solution and the matching virtual topology
+    Algorithm algorithm(n, m, lightpath_bandwidth, demands, network);
+    algorithm.Run();
+    algorithm.ResizeNogoods();
+    Solution &solution = algorithm.cur_solution_;
+    std::vector<std::vector<size_t>> paths = solution.demand_lightpaths;
+    std::vector<size_t> used_lp_idxes;
+    for (size_t lp_id = 0; lp_id < solution.lightpaths_.size(); ++lp_id) {
+        if (solution.use_of_lightpaths[lp_id]) {
+            used_lp_idxes.push_back(lp_id);
+        }
+    }
+
+    benchmark.Run("graph/get_path_edges" + suffix, m, [&](size_t i) {
+        DoNotOptimize(algorithm.SearchPath(demands[i]).size());
+    });
+
+    // The same searches with only the checks of a policy, without the stop check of the solver. A bandwidth-only
+    // search is left out, as without simplicity it enumerates exponentially many prefixes
+    auto policy_benchmark = [&](const std::string &name, auto policy) {
+        benchmark.Run("graph/get_path_edges/" + name + suffix, m, [&](size_t i) {
+            const TrafficDemand &demand = demands[i];
+            DoNotOptimize(algorithm.virtual_topology_.GetPathEdges(demand.source, demand.destination,
+                                                                   demand.bandwidth, policy).size());
+        });
+    };
+    policy_benchmark("simple", SimplePathPolicy(solution));
+    policy_benchmark("feasible", FeasiblePathPolicy(solution));
+
+    benchmark.Run("solution/unassign_assign" + suffix, m, [&](size_t i) {
+        solution.Unassign(i, demands[i].bandwidth);
+        solution.Assign(i, demands[i].bandwidth, paths[i]);
+    });
+
+    benchmark.Run("solution/copy" + suffix, 16, [&](size_t) {
+        Solution copy = solution;
+        DoNotOptimize(copy.lightpaths_number_);
+    });
+
+    Validator validator(n, m, lightpath_bandwidth, solution, network, demands);
+    benchmark.Run("validator/is_simple" + suffix, m, [&](size_t i) {
+        DoNotOptimize(validator.IsSimple(paths[i]));
+    });
+
+    benchmark.Run("validator/validate" + suffix, 1, [&](size_t) {
+        DoNotOptimize(validator.Validate());
+    });
+
+    // Every removal is rolled back, and the nogoods are cleared so that repeated failures are searched again
+    benchmark.Run("algorithm/grooming" + suffix, used_lp_idxes.size(), [&](size_t i) {
+        size_t lp_id = used_lp_idxes[i];
+        algorithm.ClearNogoods();
+        solution.Checkpoint();
+        bool groomed = algorithm.Grooming(lp_id);
+        solution.Rollback();
+        if (groomed) {
+            algorithm.virtual_topology_.AddEdge(solution.lightpaths_[lp_id].source,
+                                                solution.lightpaths_[lp_id].destination, lp_id);
+        }
+    });
+}
@@ -1,11 +1,17 @@
 #include "headers/generator.h"
 
+#include <algorithm>
+#include <cmath>
+#include <numeric>
 #include <random>
 #include <vector>
 
 Generator::Generator() : gen_(std::random_device{}()) {
 }
 
+Generator::Generator(size_t seed) : gen_(seed) {
+}
+
 void Generator::GenerateInput(size_t n, size_t m, size_t &lightpath_bandwidth,
                               std::vector<std::vector<size_t>> &adj_matrix,
                               std::vector<TrafficDemand> &demands) {
@@ -63,3 +69,275 @@ void Generator::GenerateDemands(size_t n, size_t m, size_t &lightpath_bandwidth,
     }
 }
 
+void Generator::DriftDemands(size_t n, double drift, std::vector<TrafficDemand> &demands) {
+    std::uniform_real_distribution<double> probability(0.0, 1.0);
+
+    for (TrafficDemand &demand: demands) {
+        double p = probability(gen_);
+        if (p >= drift) {
+            continue;
+        }
+
+        if (p < drift / 2) {
+            distribution_.param(std::uniform_int_distribution<size_t>::param_type(0, n - 1));
+            do {
+                demand.source = distribution_(gen_);
+                demand.destination = distribution_(gen_);
+            } while (demand.source == demand.destination);
+        } else {
+            distribution_.param(std::uniform_int_distribution<size_t>::param_type(1, 5));
+            demand.bandwidth = distribution_(gen_);
+        }
+    }
+}
+
+std::vector<Edge> Generator::GenerateRing(size_t n) {
+    std::vector<Edge> edges;
+    for (size_t i = 0; i + 1 < n; ++i) {
+        edges.push_back({i, i + 1});
+    }
+    if (n > 2) {
+        edges.push_back({n - 1, 0});
+    }
+    return edges;
+}
+
+std::vector<Edge> Generator::GenerateGrid(size_t rows, size_t columns, bool wrapped) {
+    std::vector<Edge> edges;
+    for (size_t row = 0; row < rows; ++row) {
+        for (size_t column = 0; column < columns; ++column) {
+            size_t node = row * columns + column;
+            if (column + 1 < columns) {
+                edges.push_back({node, node + 1});
+            } else if (wrapped && columns > 2) {
+                edges.push_back({node, row * columns});
+            }
+            if (row + 1 < rows) {
+                edges.push_back({node, node + columns});
+            } else if (wrapped && rows > 2) {
+                edges.push_back({node, column});
+            }
+        }
+    }
+    return edges;
+}
+
+std::vector<Edge> Generator::GenerateWaxman(size_t n, double average_degree, double alpha) {
+    std::uniform_real_distribution<double> coordinate(0.0, 1.0);
+    std::vector<double> x(n);
+    std::vector<double> y(n);
+    for (size_t i = 0; i < n; ++i) {
+        x[i] = coordinate(gen_);
+        y[i] = coordinate(gen_);
+    }
+    std::vector<Edge> edges;
+    if (n < 2 || average_degree <= 0.0) {
+        ConnectComponents(n, edges);
+        return edges;
+    }
+
+    // beta is chosen so that the expected degree is average_degree, with the mean of exp(-d(u, v) / (alpha * L))
+    // estimated on random pairs of the placed nodes
+    double scale = alpha * std::sqrt(2.0);
+    std::uniform_int_distribution<size_t> node(0, n - 1);
+    double proximity = 0.0;
+    for (size_t i = 0; i < kWaxmanSamples; ++i) {
+        size_t u = node(gen_);
+        size_t v = node(gen_);
+        proximity += std::exp(-std::hypot(x[u] - x[v], y[u] - y[v]) / scale);
+    }
+    proximity /= kWaxmanSamples;
+    double beta = std::min(1.0, average_degree / ((n - 1) * proximity));
+
+    // Nodes are bucketed into a grid of cells about scale wide. The pairs of two cells are skipped geometrically with
+    // the probability of their closest possible points, and a pair the skip lands on is accepted with the ratio of
+    // its own probability to that bound, so the work is linear in the edges and not in the pairs
+    size_t cells_number = std::min<size_t>(kWaxmanGridSize, std::ceil(1.0 / scale));
+    auto cell_of = [cells_number](double coordinate) {
+        return std::min<size_t>(cells_number - 1, coordinate * cells_number);
+    };
+    std::vector<size_t> cell_offsets(cells_number * cells_number + 1, 0);
+    for (size_t i = 0; i < n; ++i) {
+        ++cell_offsets[cell_of(y[i]) * cells_number + cell_of(x[i]) + 1];
+    }
+    std::partial_sum(cell_offsets.begin(), cell_offsets.end(), cell_offsets.begin());
+    std::vector<size_t> cell_nodes(n);
+    std::vector<size_t> positions(cell_offsets.begin(), cell_offsets.end() - 1);
+    for (size_t i = 0; i < n; ++i) {
+        cell_nodes[positions[cell_of(y[i]) * cells_number + cell_of(x[i])]++] = i;
+    }
+
+    // Width of the free space between two columns, or two rows, of cells
+    auto gap_of = [cells_number](size_t first, size_t second) {
+        size_t cells_between = std::max(first, second) - std::min(first, second);
+        return cells_between == 0 ? 0.0 : double(cells_between - 1) / cells_number;
+    };
+    for (size_t first = 0; first < cells_number * cells_number; ++first) {
+        for (size_t second = first; second < cells_number * cells_number; ++second) {
+            size_t first_size = cell_offsets[first + 1] - cell_offsets[first];
+            size_t second_size = cell_offsets[second + 1] - cell_offsets[second];
+            if (first_size == 0 || second_size == 0) {
+                continue;
+            }
+            double gap = std::hypot(gap_of(first % cells_number, second % cells_number),
+                                    gap_of(first / cells_number, second / cells_number));
+            // The bound is kept inside (0, 1) as the geometric distribution needs, an underflow to 0 included. Raising
+            // it only lowers the acceptance ratio, so the pairs keep their probabilities
+            double bound = std::clamp(beta * std::exp(-gap / scale), kWaxmanMinBound, 1.0 - kWaxmanMinBound);
+
+            // Within one cell only the pairs with i < j are taken, the others are skipped over
+            std::geometric_distribution<size_t> skip(bound);
+            for (size_t pair = skip(gen_); pair < first_size * second_size; pair += skip(gen_) + 1) {
+                size_t i = pair / second_size;
+                size_t j = pair % second_size;
+                if (first == second && i >= j) {
+                    continue;
+                }
+                size_t u = cell_nodes[cell_offsets[first] + i];
+                size_t v = cell_nodes[cell_offsets[second] + j];
+                double probability = beta * std::exp(-std::hypot(x[u] - x[v], y[u] - y[v]) / scale);
+                if (coordinate(gen_) * bound < probability) {
+                    edges.push_back({std::min(u, v), std::max(u, v)});
+                }
+            }
+        }
+    }
+
+    ConnectComponents(n, edges);
+    return edges;
+}
+
+std::vector<Edge> Generator::GenerateBarabasiAlbert(size_t n, size_t edges_per_node) {
+    std::vector<Edge> edges;
+    size_t initial_number = std::min(n, edges_per_node + 1);
+    for (size_t u = 0; u < initial_number; ++u) {
+        for (size_t v = u + 1; v < initial_number; ++v) {
+            edges.push_back({u, v});
+        }
+    }
+
+    // Every node appears in endpoints once per incident edge, so a uniform pick from it is a degree-biased pick
+    std::vector<size_t> endpoints;
+    for (const Edge &edge: edges) {
+        endpoints.push_back(edge.source);
+        endpoints.push_back(edge.destination);
+    }
+
+    std::vector<size_t> targets;
+    for (size_t node = initial_number; node < n; ++node) {
+        targets.clear();
+        distribution_.param(std::uniform_int_distribution<size_t>::param_type(0, endpoints.size() - 1));
+        while (targets.size() < std::min(edges_per_node, node)) {
+            size_t target = endpoints[distribution_(gen_)];
+            if (std::find(targets.begin(), targets.end(), target) == targets.end()) {
+                targets.push_back(target);
+            }
+        }
+        for (size_t target: targets) {
+            edges.push_back({node, target});
+            endpoints.push_back(node);
+            endpoints.push_back(target);
+        }
+    }
+
+    // Without edges per node the nodes are only linked here
+    ConnectComponents(n, edges);
+    return edges;
+}
+
+std::vector<Edge> Generator::GeneratePaperMesh(size_t instance) {
+    // Every instance is the same ring 0-1-...-7 closed by 8 and 9, with some chords
+    std::vector<Edge> edges = {{0, 1}, {0, 7}, {0, 8}, {1, 2}, {2, 3}, {3, 4}, {4, 5}, {5, 6}, {5, 9}, {6, 7},
+                               {7, 8}, {8, 9}};
+    switch (instance) {
+        case 2:
+            edges.insert(edges.end(), {{1, 8}, {2, 4}, {4, 9}});
+            break;
+        case 3:
+            edges.insert(edges.end(), {{1, 8}, {2, 6}, {4, 9}});
+            break;
+        case 6:
+            edges.push_back({2, 6});
+            break;
+        default:
+            break;
+    }
+    return edges;
+}
+
+std::vector<TrafficDemand> Generator::GenerateDemands(size_t n, size_t m, const DemandsConfig &config) {
+    std::vector<TrafficDemand> demands(m);
+    std::uniform_int_distribution<size_t> nodes(0, n - 1);
+    std::uniform_int_distribution<size_t> bandwidths(config.min_bandwidth, config.max_bandwidth);
+    std::uniform_real_distribution<double> probability(0.0, 1.0);
+
+    std::discrete_distribution<size_t> weighted_nodes;
+    if (config.model == DemandModel::kGravity) {
+        std::uniform_real_distribution<double> weight(1.0, 10.0);
+        std::vector<double> weights(n);
+        for (double &node_weight: weights) {
+            node_weight = weight(gen_);
+        }
+        weighted_nodes = std::discrete_distribution<size_t>(weights.begin(), weights.end());
+    }
+
+    std::vector<size_t> hotspots(n);
+    std::iota(hotspots.begin(), hotspots.end(), 0);
+    std::shuffle(hotspots.begin(), hotspots.end(), gen_);
+    hotspots.resize(std::max<size_t>(1, std::min(config.hotspots_number, n)));
+    std::uniform_int_distribution<size_t> hotspot(0, hotspots.size() - 1);
+
+    for (TrafficDemand &demand: demands) {
+        do {
+            if (config.model == DemandModel::kGravity) {
+                demand.source = weighted_nodes(gen_);
+                demand.destination = weighted_nodes(gen_);
+            } else {
+                demand.source = nodes(gen_);
+                demand.destination = nodes(gen_);
+                if (config.model == DemandModel::kHotspot && probability(gen_) < config.hotspot_share) {
+                    demand.source = hotspots[hotspot(gen_)];
+                    if (probability(gen_) < 0.5) {
+                        std::swap(demand.source, demand.destination);
+                    }
+                }
+            }
+        } while (demand.source == demand.destination);
+        demand.bandwidth = bandwidths(gen_);
+    }
+
+    return demands;
+}
+
+void Generator::ConnectComponents(size_t n, std::vector<Edge> &edges) {
+    std::vector<size_t> parents(n);
+    std::iota(parents.begin(), parents.end(), 0);
+    auto find = [&parents](size_t node) {
+        while (parents[node] != node) {
+            parents[node] = parents[parents[node]];
+            node = parents[node];
+        }
+        return node;
+    };
+    for (const Edge &edge: edges) {
+        parents[find(edge.source)] = find(edge.destination);
+    }
+
+    // A random node of every component is linked to a random node of the previous one
+    std::vector<std::vector<size_t>> components(n);
+    for (size_t node = 0; node < n; ++node) {
+        components[find(node)].push_back(node);
+    }
+    const std::vector<size_t> *previous = nullptr;
+    for (const std::vector<size_t> &component: components) {
+        if (component.empty()) {
+            continue;
+        }
+        if (previous != nullptr) {
+            std::uniform_int_distribution<size_t> previous_nodes(0, previous->size() - 1);
+            std::uniform_int_distribution<size_t> nodes(0, component.size() - 1);
+            edges.push_back({(*previous)[previous_nodes(gen_)], component[nodes(gen_)]});
+        }
+        previous = &component;
+    }
+}
@@ -1,126 +1,398 @@
 #include "headers/graph.h"
 
 #include <algorithm>
+#include <atomic>
 #include <climits>
-#include <queue>
+#include <thread>
 
-Graph::Graph(size_t n, std::vector<std::vector<size_t>> adj_matrix)
-        : n_(n),
-          adj_list_(std::vector<std::unordered_set<std::pair<size_t, size_t>, boost::hash<std::pair<size_t, size_t>>>>(
-                  n)),
-          distances_(std::vector<std::vector<size_t>>(n, std::vector<size_t>(n, SIZE_MAX << 1))) {
+// Runs task(i) for every i in [0, count) on all hardware threads
+template <typename Task>
+static void ParallelFor(size_t count, const Task &task) {
+    size_t workers_number = std::min<size_t>(count, std::max(1u, std::thread::hardware_concurrency()));
+    std::atomic<size_t> next(0);
+    auto work = [&next, count, &task]() {
+        for (size_t i = next++; i < count; i = next++) {
+            task(i);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < workers_number; ++i) {
+        workers.emplace_back(work);
+    }
+    work();
+    for (std::thread &worker: workers) {
+        worker.join();
+    }
+}
+
+Graph::Graph(size_t n, std::vector<std::vector<size_t>> adj_matrix, DistancesAlgorithm distances_algorithm)
+        : n_(n), csr_offsets_(n + 1, 0), adj_list_(n), removed_slots_(n, 0) {
     if (!adj_matrix.empty()) {
         for (size_t i = 0; i < n_; ++i) {
-            distances_[i][i] = 0;
-            for (size_t j = i + 1; j < n_; ++j) {
-                if (adj_matrix[i][j]) {
-                    distances_[i][j] = 1;
-                    distances_[j][i] = 1;
-
-                    adj_list_[i].emplace(j, 0);
-                    adj_list_[j].emplace(i, 0);
+            for (size_t j = 0; j < n_; ++j) {
+                if (i != j && adj_matrix[std::min(i, j)][std::max(i, j)]) {
+                    csr_neighbours_.push_back(j);
                 }
             }
+            csr_offsets_[i + 1] = csr_neighbours_.size();
         }
 
-        CalculateDistances();
+        PrepareDistances(distances_algorithm);
     }
 }
 
-bool Graph::DFS(std::vector<size_t> &edge_path, std::vector<bool> &visited, size_t cur_v, size_t from,
-                size_t to, size_t bandwidth,
-                const std::function<bool(const std::vector<size_t> &, size_t)> &is_path_ok) const {
-    visited[cur_v] = true;
-
-    if (cur_v == to) {
-        return is_path_ok(edge_path, bandwidth);
+Graph::Graph(size_t n, Span<Edge> edges, DistancesAlgorithm distances_algorithm)
+        : n_(n), csr_offsets_(n + 1, 0), adj_list_(n), removed_slots_(n, 0) {
+    for (const Edge &edge: edges) {
+        if (edge.source != edge.destination) {
+            ++csr_offsets_[edge.source + 1];
+            ++csr_offsets_[edge.destination + 1];
+        }
+    }
+    for (size_t i = 0; i < n_; ++i) {
+        csr_offsets_[i + 1] += csr_offsets_[i];
     }
 
-    for (auto [neighbour, edge_number] : adj_list_[cur_v]) {
-        if (!visited[neighbour]) {
-            edge_path.push_back(edge_number);
-            if (DFS(edge_path, visited, neighbour, from, to, bandwidth, is_path_ok)) {
-                return true;
-            }
-            edge_path.pop_back();
-            visited[neighbour] = false;
+    csr_neighbours_.resize(csr_offsets_[n_]);
+    std::vector<size_t> positions(csr_offsets_.begin(), csr_offsets_.end() - 1);
+    for (const Edge &edge: edges) {
+        if (edge.source != edge.destination) {
+            csr_neighbours_[positions[edge.source]++] = edge.destination;
+            csr_neighbours_[positions[edge.destination]++] = edge.source;
         }
     }
 
-    visited[cur_v] = false;
+    // Neighbours are kept sorted and unique, as when they are read from an adjacency matrix
+    size_t size = 0;
+    for (size_t i = 0; i < n_; ++i) {
+        auto begin = csr_neighbours_.begin() + csr_offsets_[i];
+        auto end = csr_neighbours_.begin() + csr_offsets_[i + 1];
+        std::sort(begin, end);
+        end = std::unique(begin, end);
+        csr_offsets_[i] = size;
+        size = std::copy(begin, end, csr_neighbours_.begin() + size) - csr_neighbours_.begin();
+    }
+    csr_offsets_[n_] = size;
+    csr_neighbours_.resize(size);
+
+    PrepareDistances(distances_algorithm);
+}
+
+void Graph::GetPathVertices(size_t from, size_t to, std::vector<size_t> &path) const {
+    path.clear();
+    if (GetDistance(from, to) == kInfinity) {
+        return;
+    }
 
-    return false;
+    path.push_back(from);
+    if (destination_trees_ != nullptr) {
+        const DestinationTree &tree = GetDestinationTree(to);
+        for (size_t v = from; v != to; v = tree.next_hops[v]) {
+            path.push_back(tree.next_hops[v]);
+        }
+        return;
+    }
+    for (size_t v = from; v != to; v = next_hops_[v * n_ + to]) {
+        path.push_back(next_hops_[v * n_ + to]);
+    }
 }
 
-std::vector<size_t> Graph::GetPathEdges(size_t from, size_t to, size_t bandwidth,
-                                            const std::function<bool(const std::vector<size_t> &, size_t)> &is_path_ok) const {
-    std::vector<bool> visited(n_, false);
+std::vector<size_t> Graph::GetPathVertices(size_t from, size_t to) const {
     std::vector<size_t> path;
-    DFS(path, visited, from, from, to, bandwidth, is_path_ok);
+    GetPathVertices(from, to, path);
     return path;
 }
 
-std::vector<size_t> Graph::GetPathVertices(size_t from, size_t to) const {
-    std::vector<size_t> dist(n_, SIZE_MAX);
-    std::vector<size_t> parents(n_, SIZE_MAX);
-    std::priority_queue<std::pair<size_t, size_t>, std::vector<std::pair<size_t, size_t>>, std::greater<>> queue;
+size_t Graph::GetDistance(size_t source, size_t destination) const {
+    // Links are undirected, so the distance from the source is the one towards the destination
+    if (destination_trees_ != nullptr) {
+        return GetDestinationTree(destination).distances[source];
+    }
+    return distances_[source * n_ + destination];
+}
+
+const Graph::DestinationTree &Graph::GetDestinationTree(size_t destination) const {
+    std::atomic<const DestinationTree *> &slot = destination_trees_->trees[destination];
+    const DestinationTree *tree = slot.load(std::memory_order_acquire);
+    if (tree != nullptr) {
+        return *tree;
+    }
+
+    // A breadth-first search from the destination reaches every vertex from its next hop towards it
+    auto *new_tree = new DestinationTree{std::vector<size_t>(n_, kInfinity), std::vector<size_t>(n_, SIZE_MAX)};
+    std::vector<size_t> queue;
+    queue.reserve(n_);
+    new_tree->distances[destination] = 0;
+    new_tree->next_hops[destination] = destination;
+    queue.push_back(destination);
+    for (size_t head = 0; head < queue.size(); ++head) {
+        size_t vertex = queue[head];
+        for (size_t i = csr_offsets_[vertex]; i < csr_offsets_[vertex + 1]; ++i) {
+            size_t neighbour = csr_neighbours_[i];
+            if (new_tree->distances[neighbour] == kInfinity) {
+                new_tree->distances[neighbour] = new_tree->distances[vertex] + 1;
+                new_tree->next_hops[neighbour] = vertex;
+                queue.push_back(neighbour);
+            }
+        }
+    }
+
+    if (!slot.compare_exchange_strong(tree, new_tree, std::memory_order_acq_rel)) {
+        delete new_tree;
+        return *tree;
+    }
+    return *new_tree;
+}
+
+void Graph::AddEdge(size_t source, size_t destination, size_t id) {
+    if (id >= edge_slots_.size()) {
+        edge_slots_.resize(id + 1);
+    }
+
+    EdgeSlots &edge = edge_slots_[id];
+    edge.source = source;
+    edge.source_position = adj_list_[source].size();
+    adj_list_[source].push_back({destination, id});
+
+    edge.destination = destination;
+    edge.destination_position = edge.source_position;
+    if (source != destination) {
+        edge.destination_position = adj_list_[destination].size();
+        adj_list_[destination].push_back({source, id});
+    }
+}
+
+void Graph::RemoveEdge(size_t source, size_t destination, size_t id) {
+    const EdgeSlots &edge = edge_slots_[id];
+    adj_list_[edge.source][edge.source_position].id = kRemoved;
+    ++removed_slots_[edge.source];
+    if (edge.source != edge.destination) {
+        adj_list_[edge.destination][edge.destination_position].id = kRemoved;
+        ++removed_slots_[edge.destination];
+    }
+
+    Compact(source);
+    if (source != destination) {
+        Compact(destination);
+    }
+}
+
+bool Graph::HasLink(size_t u, size_t v) const {
+    if (u >= n_ || v >= n_) {
+        return false;
+    }
+    return std::binary_search(csr_neighbours_.begin() + csr_offsets_[u], csr_neighbours_.begin() + csr_offsets_[u + 1],
+                              v);
+}
+
+bool Graph::HasEdge(size_t id) const {
+    if (id >= edge_slots_.size()) {
+        return false;
+    }
 
-    dist[from] = 0;
-    queue.emplace(0, from);
+    // The slots of a removed edge are not updated by Compact, so its position can be out of range or taken
+    const EdgeSlots &edge = edge_slots_[id];
+    const std::vector<Slot> &slots = adj_list_[edge.source];
+    return edge.source_position < slots.size() && slots[edge.source_position].id == id;
+}
 
-    while (!queue.empty()) {
-        size_t cur_dist = queue.top().first;
-        size_t cur_vertex = queue.top().second;
-        queue.pop();
+void Graph::Compact(size_t vertex) {
+    std::vector<Slot> &slots = adj_list_[vertex];
+    if (removed_slots_[vertex] * 2 <= slots.size()) {
+        return;
+    }
 
-        if (cur_dist > dist[cur_vertex]) {
+    size_t size = 0;
+    for (const Slot &slot: slots) {
+        if (slot.id == kRemoved) {
             continue;
         }
 
-        for (const auto &edge: adj_list_[cur_vertex]) {
-            size_t neighbor = edge.first;
-
-            if (dist[neighbor] > dist[cur_vertex] + 1) {
-                dist[neighbor] = dist[cur_vertex] + 1;
-                parents[neighbor] = cur_vertex;
-                queue.emplace(dist[neighbor], neighbor);
-            }
+        EdgeSlots &edge = edge_slots_[slot.id];
+        if (edge.source == vertex) {
+            edge.source_position = size;
+        }
+        if (edge.destination == vertex) {
+            edge.destination_position = size;
         }
+        slots[size++] = slot;
     }
+    slots.resize(size);
+    removed_slots_[vertex] = 0;
+}
 
-    std::vector<size_t> path;
-    if (dist[to] == SIZE_MAX) {
-        return path;
+void Graph::NextEpoch() const {
+    if (visited_.size() != n_ || ++epoch_ == 0) {
+        visited_.assign(n_, 0);
+        epoch_ = 1;
     }
+}
 
-    for (size_t v = to; v != SIZE_MAX; v = parents[v]) {
-        path.push_back(v);
+void Graph::PrepareDistances(DistancesAlgorithm distances_algorithm) {
+    if (n_ > kMaxTableNodes) {
+        destination_trees_ = std::make_shared<DestinationTrees>(n_);
+        return;
     }
-    std::reverse(path.begin(), path.end());
+    CalculateDistances(distances_algorithm);
+    CalculateNextHops();
+}
 
-    return path;
+void Graph::CalculateDistances(DistancesAlgorithm distances_algorithm) {
+    distances_.assign(n_ * n_, kInfinity);
+    switch (distances_algorithm) {
+        case DistancesAlgorithm::kFloyd:
+            CalculateDistancesFloyd();
+            break;
+        case DistancesAlgorithm::kBfs:
+            CalculateDistancesBfs();
+            break;
+        case DistancesAlgorithm::kBitParallelBfs:
+            CalculateDistancesBitParallelBfs();
+            break;
+    }
 }
 
-size_t Graph::GetDistance(size_t source, size_t destination) const {
-    return distances_[source][destination];
+void Graph::CalculateDistancesFloyd() {
+    // Blocked Floyd-Warshall: the diagonal block of every round goes first, then the blocks in its row and column,
+    // then all the rest. The inner loop runs over contiguous rows, so the compiler can vectorize it. Unreachable
+    // pairs are kept as `unreachable` during the computation, so that adding two of them does not overflow
+    static constexpr size_t kBlockSize = 64;
+    static constexpr size_t unreachable = SIZE_MAX / 4;
+
+    for (size_t u = 0; u < n_; ++u) {
+        distances_[u * n_ + u] = 0;
+        for (size_t i = csr_offsets_[u]; i < csr_offsets_[u + 1]; ++i) {
+            distances_[u * n_ + csr_neighbours_[i]] = 1;
+        }
+    }
+    for (size_t &distance: distances_) {
+        distance = std::min(distance, unreachable);
+    }
+
+    size_t *distances = distances_.data();
+    size_t n = n_;
+    auto update_block = [distances, n](size_t u_begin, size_t v_begin, size_t k_begin) {
+        size_t u_end = std::min(u_begin + kBlockSize, n);
+        size_t v_end = std::min(v_begin + kBlockSize, n);
+        size_t k_end = std::min(k_begin + kBlockSize, n);
+        for (size_t k = k_begin; k < k_end; ++k) {
+            const size_t *k_row = distances + k * n;
+            for (size_t u = u_begin; u < u_end; ++u) {
+                size_t *u_row = distances + u * n;
+                size_t u_k = u_row[k];
+                for (size_t v = v_begin; v < v_end; ++v) {
+                    u_row[v] = std::min(u_row[v], u_k + k_row[v]);
+                }
+            }
+        }
+    };
+
+    for (size_t k = 0; k < n_; k += kBlockSize) {
+        update_block(k, k, k);
+        for (size_t i = 0; i < n_; i += kBlockSize) {
+            if (i != k) {
+                update_block(k, i, k);
+                update_block(i, k, k);
+            }
+        }
+        for (size_t u = 0; u < n_; u += kBlockSize) {
+            for (size_t v = 0; v < n_; v += kBlockSize) {
+                if (u != k && v != k) {
+                    update_block(u, v, k);
+                }
+            }
+        }
+    }
+
+    for (size_t &distance: distances_) {
+        if (distance >= unreachable) {
+            distance = kInfinity;
+        }
+    }
 }
 
-void Graph::AddEdge(size_t source, size_t destination, size_t id) {
-    adj_list_[source].emplace(destination, id);
-    adj_list_[destination].emplace(source, id);
+void Graph::CalculateDistancesBfs() {
+    ParallelFor(n_, [this](size_t source) {
+        size_t *row = distances_.data() + source * n_;
+        std::vector<size_t> queue;
+        queue.reserve(n_);
+
+        row[source] = 0;
+        queue.push_back(source);
+        for (size_t head = 0; head < queue.size(); ++head) {
+            size_t vertex = queue[head];
+            for (size_t i = csr_offsets_[vertex]; i < csr_offsets_[vertex + 1]; ++i) {
+                size_t neighbour = csr_neighbours_[i];
+                if (row[neighbour] == kInfinity) {
+                    row[neighbour] = row[vertex] + 1;
+                    queue.push_back(neighbour);
+                }
+            }
+        }
+    });
 }
 
-void Graph::RemoveEdge(size_t source, size_t destination, size_t id) {
-    adj_list_[source].erase({destination, id});
-    adj_list_[destination].erase({source, id});
+void Graph::CalculateDistancesBitParallelBfs() {
+    // Runs BFS from 64 sources at once: bit i of a vertex mask stands for the i-th source of the batch
+    static constexpr size_t kBatchSize = 64;
+    size_t batches_number = (n_ + kBatchSize - 1) / kBatchSize;
+
+    ParallelFor(batches_number, [this](size_t batch) {
+        size_t first_source = batch * kBatchSize;
+        size_t sources_number = std::min(kBatchSize, n_ - first_source);
+
+        std::vector<uint64_t> visited(n_, 0);
+        std::vector<uint64_t> frontier(n_, 0);
+        std::vector<uint64_t> next_frontier(n_, 0);
+        for (size_t i = 0; i < sources_number; ++i) {
+            visited[first_source + i] = frontier[first_source + i] = uint64_t(1) << i;
+            distances_[(first_source + i) * n_ + first_source + i] = 0;
+        }
+
+        for (size_t distance = 1;; ++distance) {
+            bool changed = false;
+            for (size_t vertex = 0; vertex < n_; ++vertex) {
+                uint64_t reached = 0;
+                for (size_t i = csr_offsets_[vertex]; i < csr_offsets_[vertex + 1]; ++i) {
+                    reached |= frontier[csr_neighbours_[i]];
+                }
+                reached &= ~visited[vertex];
+                next_frontier[vertex] = reached;
+                if (reached == 0) {
+                    continue;
+                }
+
+                changed = true;
+                visited[vertex] |= reached;
+                for (; reached != 0; reached &= reached - 1) {
+                    size_t source = first_source + __builtin_ctzll(reached);
+                    distances_[source * n_ + vertex] = distance;
+                }
+            }
+            if (!changed) {
+                break;
+            }
+            frontier.swap(next_frontier);
+        }
+    });
 }
 
-void Graph::CalculateDistances() {
-    for (size_t i = 0; i < n_; ++i) {
-        for (size_t u = 0; u < n_; ++u) {
+void Graph::CalculateNextHops() {
+    next_hops_.assign(n_ * n_, SIZE_MAX);
+    ParallelFor(n_, [this](size_t u) {
+        const size_t *u_distances = distances_.data() + u * n_;
+        size_t *u_next_hops = next_hops_.data() + u * n_;
+        u_next_hops[u] = u;
+        for (size_t i = csr_offsets_[u]; i < csr_offsets_[u + 1]; ++i) {
+            size_t neighbour = csr_neighbours_[i];
+            const size_t *neighbour_distances = distances_.data() + neighbour * n_;
             for (size_t v = 0; v < n_; ++v) {
-                distances_[u][v] = std::min(distances_[u][v], distances_[u][i] + distances_[i][v]);
+                if (u_next_hops[v] == SIZE_MAX && u_distances[v] != kInfinity &&
+                    neighbour_distances[v] + 1 == u_distances[v]) {
+                    u_next_hops[v] = neighbour;
+                }
             }
         }
-    }
+    });
 }
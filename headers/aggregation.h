@@ -0,0 +1,27 @@
+#pragma once
+
+#include <vector>
+
+#include "structures.h"
+
+// Merges demands with the same source and destination into aggregates, which the solver routes as single demands,
+// so that every group takes one path search and one assignment instead of one per demand. A group whose bandwidth
+// exceeds a lightpath is split into as few aggregates as first-fit packing gives, as no path can carry it whole
+class DemandAggregation {
+public:
+    DemandAggregation(const std::vector<TrafficDemand> &demands, size_t lightpath_bandwidth);
+
+    const std::vector<TrafficDemand> &GetAggregates() const;
+
+    // Every demand takes the path of its aggregate
+    Solution Expand(const Solution &aggregates_solution) const;
+
+private:
+    size_t m_;
+
+    std::vector<TrafficDemand> aggregates_;
+
+    // The demands of aggregate a are members_[members_offsets_[a]..members_offsets_[a + 1])
+    std::vector<size_t> members_offsets_;
+    std::vector<size_t> members_;
+};
@@ -1,27 +1,162 @@
 #pragma once
 
 #include "graph.h"
+#include "lower_bound.h"
+#include "path_policy.h"
+#include "run_config.h"
+#include "stats.h"
 #include "structures.h"
+#include "worker_pool.h"
+
+#include <chrono>
+#include <memory>
+#include <utility>
 
 class Algorithm {
 public:
     Algorithm(size_t n, size_t m, size_t lightpath_bandwidth, const std::vector<TrafficDemand> &traffic_demands,
-          const Graph &network);
+          const Graph &network, size_t seed = 0);
+
+    // Warm start: the lightpaths used by the previous solution, e.g. of the previous traffic epoch, are kept in the
+    // virtual topology with all their bandwidth free, so that construction reuses them before creating new ones.
+    // When the previous solution still routes every demand, e.g. it is a checkpoint of an interrupted run over the
+    // same demands, it also becomes the incumbent of the first Run(), which then only returns a better one
+    Algorithm(size_t n, size_t m, size_t lightpath_bandwidth, const std::vector<TrafficDemand> &traffic_demands,
+              const Graph &network, const Solution &previous_solution, size_t seed = 0);
+
+    // Online mode: the solver starts without demands and owns the demands added by AddDemand
+    Algorithm(size_t n, size_t lightpath_bandwidth, const Graph &network);
+
+    // Stops as soon as any rule of the config is met or the best solution reaches the lower bound, and returns
+    // the best solution found so far. The first construction is always completed, so that there is a valid
+    // solution to return
+    Solution Run(const RunConfig &config = RunConfig());
+
+    const LowerBound &GetLowerBound() const;
 
-    Solution Run();
+    // Statistics of the last Run(), only collected in a build with GRASP4_STATS
+    const SolverStats &GetStats() const;
+
+    // Whether the solver was built by the online constructor and owns its demands
+    bool IsOnline() const;
+
+    // Routes a new demand against the current virtual topology and lightpath residuals like one step of Construct,
+    // then tries to groom only the lightpaths of its path. Returns the demand id, or SIZE_MAX and changes nothing
+    // if the solver is not online, as its demands are then the caller's
+    size_t AddDemand(const TrafficDemand &demand);
+
+    // Unassigns the demand and tries to groom the lightpaths it used. To keep demand ids dense, the last demand
+    // takes the id of the removed one. Returns false and changes nothing if the solver is not online or there is
+    // no such demand
+    bool RemoveDemand(size_t demand_id);
+
+    // The current solution, which is the best one right after Run()
+    const Solution &GetSolution() const;
+
+    const std::vector<TrafficDemand> &GetDemands() const;
 
 private:
-    void Construct();
+    friend class KernelBenchmarks;
+
+    // Outcome of a lightpath removal tried by a speculator: the new path of every demand of the lightpath, in the
+    // order they were rerouted, or for a failed removal the nogood learned for the demand that had no path
+    struct Speculation {
+        size_t lp_id;
+        bool groomed;
+        std::vector<std::pair<size_t, std::vector<size_t>>> reroutes;
+        size_t nogood_demand_id = SIZE_MAX;
+        std::vector<uint64_t> nogood;
+        StatsCounters stats;
+    };
+
+    bool Construct();
+
+    void RouteDemand(size_t demand_id);
+
+    // Routes the demand over a path of existing lightpaths to an intermediate node and a new lightpath from there
+    // to the destination, for a demand that has no path in the virtual topology
+    std::vector<size_t> RouteOverNewLightpath(const TrafficDemand &demand);
 
     void LightpathMin();
 
-    bool GroomDemand(std::vector<const TrafficDemand *> &demands, size_t demand_number = 0);
+    void GroomLightpaths(std::vector<size_t> lp_idxes);
+
+    void SpeculativeGroomLightpaths(const std::vector<size_t> &lp_idxes);
+
+    bool TryGrooming(size_t lp_id);
+
+    // Runs on a speculator: moves the demands off the lightpath on a replica of the origin's solution and virtual
+    // topology with the origin's nogoods of those demands, and undoes it there
+    void Speculate(const Algorithm &origin, size_t lp_id, Speculation &speculation);
+
+    // Applies a speculation made on the current solution and nogoods of its demands, which is what a serial grooming
+    // of the lightpath would do. Returns whether the lightpath was groomed
+    bool CommitSpeculation(const Speculation &speculation);
+
+    // Assigns every demand to the lightpaths of its path in the solution, lp_ids mapping the solution's lightpaths
+    // to ours. Leaves the solution unassigned and returns false if any path is no longer valid
+    bool AdoptSolution(const Solution &solution, const std::vector<size_t> &lp_ids);
+
+    void RestoreBestSolution();
+
+    // Offers the current solution to the elite pool. It enters if it is better than every member, or if it differs
+    // from every member in enough demands, and then takes the place of the most similar member that is no better
+    void UpdateElitePool(size_t capacity);
+
+    // The best elite member that has a solution in between with the current one, the one that differs from it the
+    // most among equally good ones, or nullptr if there is none
+    const Solution *ChooseGuide() const;
+
+    // Path relinking: closes the lightpaths the guide does not use one by one, by moving all their demands onto
+    // their paths in the guide, and leaves the current solution at the best one met strictly before the guide.
+    // Returns false if no lightpath could be closed
+    bool RelinkTowards(const Solution &guide);
+
+    // Reroutes the demands one by one, the most constrained first, and stops at the first one that has no path.
+    // Reroutings are recorded in the solution journal, so the caller rolls them back on failure
+    bool RerouteDemands(std::vector<size_t> &demands);
+
+    void FillUsableLightpaths(size_t bandwidth);
+
+    bool IsNogood(size_t demand_id);
+
+    void AddNogood(size_t demand_id);
+
+    void ResizeNogoods();
+
+    void ClearNogoods();
 
     bool Grooming(size_t lp_id);
 
-    bool HasEnoughBandwidth(const std::vector<size_t> &path, size_t bandwidth);
+    // Moves the demands of the lightpath onto other lightpaths while the searches skip it, and leaves the virtual
+    // topology as it is. Returns false at the first demand that has no path
+    bool MoveDemandsOff(size_t lp_id);
+
+    // Policy of the solver's path searches: the lightpaths that keep the path feasible for the demand, and none at
+    // all once the run is stopped
+    struct SearchPolicy {
+        Algorithm &algorithm;
+
+        bool Push(size_t lp_id, size_t bandwidth) {
+            return algorithm.PushLightpath(lp_id, bandwidth);
+        }
+
+        void Pop(size_t lp_id) {
+            algorithm.PopLightpath(lp_id);
+        }
+
+        bool Accept(const std::vector<size_t> &path) const {
+            return algorithm.feasible_path_.Accept(path);
+        }
+    };
+
+    std::vector<size_t> SearchPath(const TrafficDemand &demand);
 
-    bool IsSimple(const std::vector<size_t> &path);
+    bool PushLightpath(size_t lp_id, size_t bandwidth);
+
+    void PopLightpath(size_t lp_id);
+
+    bool ShouldStop();
 
 private:
     size_t n_;
@@ -30,10 +165,58 @@ private:
     const Graph &network_;
     Graph virtual_topology_;
 
-    std::vector<const TrafficDemand *> traffic_demands_ptrs_;
+    std::vector<TrafficDemand> online_demands_;
+    const std::vector<TrafficDemand> &traffic_demands_;
+    std::vector<size_t> demands_order_;
+
+    LowerBound lower_bound_;
+    bool demands_changed_ = false;
 
     Solution cur_solution_;
     Solution best_solution_;
+    bool has_incumbent_ = false;
+
+    SolverStats stats_;
+
+    const CancellationToken *cancellation_token_ = nullptr;
+    std::chrono::steady_clock::time_point deadline_;
+    bool interruptible_ = false;
+    bool stopped_ = false;
+    size_t pushes_number_ = 0;
+
+    size_t speculative_workers_ = 1;
+    std::vector<std::unique_ptr<Algorithm>> speculators_;
+    std::vector<Speculation> speculations_;
+    std::unique_ptr<WorkerPool> speculation_pool_;
+
+    // Bumped by the origin whenever its solution may have changed since the speculators copied it, and on a
+    // speculator the version its replica was copied at
+    size_t version_ = 0;
+    size_t replica_version_ = SIZE_MAX;
+
+    // Checks the bandwidth and the simplicity of the path prefix the current search has accepted so far
+    FeasiblePathPolicy feasible_path_;
+
+    std::vector<size_t> route_;
+    std::vector<size_t> reached_;
+    std::vector<size_t> parent_edges_;
+    std::vector<uint64_t> reach_masks_;
+
+    // A member of the elite pool that is not its best differs from every other member in the paths of at least
+    // one demand in kEliteDiversity. The pool only lives for one Run(), as its lightpath ids are those of the run
+    static constexpr size_t kEliteDiversity = 10;
+    std::vector<Solution> elite_pool_;
+    Solution relinking_start_;
+    Graph relinking_start_topology_;
+
+    // The search for a path is exhaustive and a lightpath keeps its nodes once routed, so a demand with no path over
+    // a set of usable lightpaths (in the virtual topology with enough unused bandwidth) has none over any subset of
+    // it. nogoods_[demand_id] holds such failing sets of nogood_words_ words each, and outlives the grooming passes
+    size_t nogood_words_ = 0;
+    std::vector<std::vector<uint64_t>> nogoods_;
+    std::vector<uint64_t> usable_lightpaths_;
 
-    std::function<bool(const std::vector<size_t> &, size_t)> is_path_ok_;
+    // The lightpath whose demands are being moved off. It stays in the virtual topology until its grooming succeeds,
+    // so a failed grooming leaves the order of the adjacency, and with it later searches, as it was
+    size_t groomed_lp_id_ = SIZE_MAX;
 };
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Hardware counters of the calling thread (cycles, cache misses, branch misses) read through perf_event_open.
+// Outside Linux, or when the kernel does not allow it, the counters are unavailable and simply not reported
+class PerfCounters {
+public:
+    static constexpr size_t kCountersNumber = 3;
+
+    PerfCounters();
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters &) = delete;
+    PerfCounters &operator=(const PerfCounters &) = delete;
+
+    bool IsAvailable() const;
+
+    void Start();
+
+    // Counts since the last Start()
+    void Stop(uint64_t (&values)[kCountersNumber]);
+
+private:
+    int fds_[kCountersNumber];
+};
+
+// Per-call figures of a benchmark, the counters are averaged over all timed calls
+struct BenchmarkResult {
+    std::string name;
+    size_t batch_size = 0;
+    size_t repetitions = 0;
+    double min_ns = 0;
+    double median_ns = 0;
+    double mean_ns = 0;
+
+    bool has_counters = false;
+    double cycles = 0;
+    double cache_misses = 0;
+    double branch_misses = 0;
+};
+
+// Keeps the compiler from optimizing away a value that is computed only to be measured
+template <class T>
+inline void DoNotOptimize(const T &value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+class Benchmark {
+public:
+    // Only benchmarks whose name contains the filter are run
+    Benchmark(size_t warmup_repetitions, size_t repetitions, bool use_counters, std::string filter = "");
+
+    // Every repetition times batch_size calls of op(i), i = 0..batch_size - 1, so that fast kernels are measured
+    // well above the clock resolution. The warmup repetitions are run the same way and thrown away
+    template <class Op>
+    void Run(const std::string &name, size_t batch_size, Op &&op);
+
+    bool IsSelected(const std::string &name) const;
+
+    bool HasCounters() const;
+
+    void PrintJson(std::ostream &out, size_t seed) const;
+
+private:
+    size_t warmup_repetitions_;
+    size_t repetitions_;
+    bool use_counters_;
+    std::string filter_;
+
+    PerfCounters counters_;
+    std::vector<BenchmarkResult> results_;
+};
+
+template <class Op>
+void Benchmark::Run(const std::string &name, size_t batch_size, Op &&op) {
+    if (!IsSelected(name)) {
+        return;
+    }
+
+    for (size_t repetition = 0; repetition < warmup_repetitions_; ++repetition) {
+        for (size_t i = 0; i < batch_size; ++i) {
+            op(i);
+        }
+    }
+
+    BenchmarkResult result;
+    result.name = name;
+    result.batch_size = batch_size;
+    result.repetitions = repetitions_;
+    result.has_counters = HasCounters();
+
+    std::vector<double> times(repetitions_);
+    uint64_t totals[PerfCounters::kCountersNumber] = {};
+    for (size_t repetition = 0; repetition < repetitions_; ++repetition) {
+        if (result.has_counters) {
+            counters_.Start();
+        }
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < batch_size; ++i) {
+            op(i);
+        }
+        auto stop = std::chrono::steady_clock::now();
+        if (result.has_counters) {
+            uint64_t values[PerfCounters::kCountersNumber];
+            counters_.Stop(values);
+            for (size_t counter = 0; counter < PerfCounters::kCountersNumber; ++counter) {
+                totals[counter] += values[counter];
+            }
+        }
+
+        times[repetition] = std::chrono::duration<double, std::nano>(stop - start).count() / batch_size;
+    }
+
+    std::sort(times.begin(), times.end());
+    result.min_ns = times.front();
+    result.median_ns = times[times.size() / 2];
+    for (double time: times) {
+        result.mean_ns += time / times.size();
+    }
+
+    double calls_number = static_cast<double>(batch_size * repetitions_);
+    result.cycles = totals[0] / calls_number;
+    result.cache_misses = totals[1] / calls_number;
+    result.branch_misses = totals[2] / calls_number;
+    results_.push_back(result);
+}
+
+// The solver's hot kernels on fixed seeded instances
+class KernelBenchmarks {
+public:
+    static void Run(Benchmark &benchmark, size_t seed);
+
+private:
+    static void DistancesBenchmarks(Benchmark &benchmark, size_t seed, size_t n);
+
+    static void InstanceBenchmarks(Benchmark &benchmark, size_t seed, size_t n, size_t m);
+};
@@ -2,12 +2,35 @@
 
 #include <vector>
 #include <random>
+#include "graph.h"
 #include "structures.h"
 
+// How the endpoints of generated demands are drawn
+enum class DemandModel {
+    // Every ordered pair of distinct nodes is equally likely
+    kUniform,
+    // Every node gets a random weight, and a pair is drawn with probability proportional to the product of weights
+    kGravity,
+    // A share of the demands has one endpoint among a few hotspot nodes, e.g. data centers
+    kHotspot,
+};
+
+struct DemandsConfig {
+    DemandModel model = DemandModel::kUniform;
+    size_t min_bandwidth = 1;
+    size_t max_bandwidth = 5;
+
+    size_t hotspots_number = 2;
+    double hotspot_share = 0.5;
+};
+
 class Generator {
 public:
     Generator();
 
+    // A seeded generator produces the same instances on every run
+    explicit Generator(size_t seed);
+
     void GenerateInput(size_t n, size_t m, size_t &lightpath_bandwidth,
                        std::vector<std::vector<size_t>> &adjacent_matrix, std::vector<TrafficDemand> &demands);
 
@@ -15,11 +38,46 @@ public:
 
     void GenerateDemands(size_t n, size_t m, size_t &lightpath_bandwidth, std::vector<TrafficDemand> &demands);
 
+    // Drift model between traffic epochs: every demand is redrawn with the given probability, half of the redrawn
+    // demands get new endpoints and the other half only a new bandwidth
+    void DriftDemands(size_t n, double drift, std::vector<TrafficDemand> &demands);
+
+    // Topology families of real WDM networks as connected edge lists, so that they scale to tens of thousands of
+    // nodes. Every family but the ring and the grid is random and depends on the seed
+    static std::vector<Edge> GenerateRing(size_t n);
+
+    // A rows x columns mesh, a torus if wrapped
+    static std::vector<Edge> GenerateGrid(size_t rows, size_t columns, bool wrapped = false);
+
+    // Nodes are placed uniformly in the unit square, and u and v are linked with probability
+    // beta * exp(-d(u, v) / (alpha * L)), where L is the largest possible distance. beta is scaled with n so that the
+    // average degree stays average_degree, as real networks do not get denser as they grow
+    std::vector<Edge> GenerateWaxman(size_t n, double average_degree = 4.0, double alpha = 0.15);
+
+    // Preferential attachment: every new node is linked to edges_per_node distinct nodes chosen with probability
+    // proportional to their degree
+    std::vector<Edge> GenerateBarabasiAlbert(size_t n, size_t edges_per_node = 2);
+
+    // The 10-node mesh networks of the paper's mesh_1 .. mesh_6 instances (the ones of Tester::MeshTests), its ring
+    // instances are GenerateRing(8) and GenerateRing(10)
+    static std::vector<Edge> GeneratePaperMesh(size_t instance);
+
+    std::vector<TrafficDemand> GenerateDemands(size_t n, size_t m, const DemandsConfig &config);
+
 private:
+    // Pairs sampled to estimate beta of a Waxman network, the largest number of grid cells along one side, and the
+    // distance of the skip probability of a pair of cells from 0 and 1
+    static constexpr size_t kWaxmanSamples = 4096;
+    static constexpr size_t kWaxmanGridSize = 16;
+    static constexpr double kWaxmanMinBound = 1e-12;
+
     static void InitializeConnectedGraph(size_t n, std::vector<std::vector<size_t>> &adj_matrix);
 
     void AddRandomEdges(size_t n, std::vector<std::vector<size_t>> &adj_matrix);
 
+    // Links every connected component to the next one, as the solver needs a connected network
+    void ConnectComponents(size_t n, std::vector<Edge> &edges);
+
 private:
     std::mt19937 gen_;
     std::uniform_int_distribution<size_t> distribution_;
@@ -1,31 +1,252 @@
 #pragma once
 
-#include <boost/functional/hash.hpp>
-#include <functional>
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <vector>
-#include <unordered_set>
+
+#include "span.h"
+#include "stats.h"
+#include "trace.h"
+
+// Algorithm used to compute all-pairs distances of a physical network. All of them give the same distances,
+// BFS-based ones only work because physical links have unit length
+enum class DistancesAlgorithm {
+    kFloyd,
+    kBfs,
+    kBitParallelBfs,
+};
+
+// An undirected physical link
+struct Edge {
+    size_t source;
+    size_t destination;
+};
 
 class Graph {
 public:
-    explicit Graph(size_t n, std::vector<std::vector<size_t>> adj_matrix = {});
+    static constexpr size_t kInfinity = SIZE_MAX << 1;
+
+    // The n x n distance and next-hop tables of a physical network are only built up to this many nodes, which
+    // keeps them under 64 MiB. A larger network computes the shortest path tree towards a destination the first
+    // time it is asked for, and keeps it, so it holds n words for every destination in use instead
+    static constexpr size_t kMaxTableNodes = 2048;
+
+    explicit Graph(size_t n, std::vector<std::vector<size_t>> adj_matrix = {},
+                   DistancesAlgorithm distances_algorithm = DistancesAlgorithm::kFloyd);
+
+    // Physical network from an edge list, which never needs the n x n adjacency matrix. Self-loops and repeated
+    // edges are dropped
+    Graph(size_t n, Span<Edge> edges, DistancesAlgorithm distances_algorithm = DistancesAlgorithm::kBfs);
+
+    // Searches for a simple path of edges from `from` to `to`. Every edge is offered to policy.Push(edge, bandwidth)
+    // before it is appended to the current prefix, so infeasible prefixes are cut immediately; policy.Pop(edge) is
+    // called for every accepted edge when it leaves the prefix, including the edges of the returned path, and a
+    // complete path is only returned if policy.Accept(path) agrees (see path_policy.h).
+    // Uses internal scratch buffers, so it must not be called concurrently on the same graph.
+    template <class Policy>
+    std::vector<size_t> GetPathEdges(size_t from, size_t to, size_t bandwidth, Policy &policy) const;
+
+    // Breadth-first search from `from` that only follows an edge if extend(vertex, neighbour, edge) accepts it as
+    // the continuation of the search tree path of `vertex`. Writes the reached vertices in the order they are reached,
+    // `from` first, and the edge every reached vertex but `from` is reached by into parent_edges[vertex].
+    // Uses internal scratch buffers, so it must not be called concurrently on the same graph.
+    template <class Extend>
+    void GetReachableVertices(size_t from, const Extend &extend, std::vector<size_t> &reached,
+                              std::vector<size_t> &parent_edges) const;
 
-    std::vector<size_t> GetPathEdges(size_t from, size_t to, size_t bandwidth,
-                                     const std::function<bool(const std::vector<size_t> &, size_t)> &is_path_ok) const;
+    // Writes a shortest path of the physical network from `from` to `to` into `path` by walking the next-hop table,
+    // `path` is left empty if `to` is unreachable
+    void GetPathVertices(size_t from, size_t to, std::vector<size_t> &path) const;
     std::vector<size_t> GetPathVertices(size_t from, size_t to) const;
 
     size_t GetDistance(size_t source, size_t destination) const;
 
+    // Whether the physical network has a link between u and v, vertices out of range have none
+    bool HasLink(size_t u, size_t v) const;
+
     void AddEdge(size_t source, size_t destination, size_t id);
     void RemoveEdge(size_t source, size_t destination, size_t id);
 
+    bool HasEdge(size_t id) const;
+
 private:
-    void CalculateDistances();
+    static constexpr size_t kRemoved = SIZE_MAX;
+
+    // An edge incident to a vertex of a dynamic graph. Removed edges leave a tombstone with id == kRemoved
+    // in place, so that the remaining slots keep their insertion order and positions
+    struct Slot {
+        size_t neighbour;
+        size_t id;
+    };
+
+    // Positions of the two slots of an edge, indexed by the edge id
+    struct EdgeSlots {
+        size_t source;
+        size_t source_position;
+        size_t destination;
+        size_t destination_position;
+    };
+
+    struct SearchFrame {
+        size_t vertex;
+        size_t next;
+    };
+
+    void CalculateDistances(DistancesAlgorithm distances_algorithm);
+    void CalculateDistancesFloyd();
+    void CalculateDistancesBfs();
+    void CalculateDistancesBitParallelBfs();
+
+    void CalculateNextHops();
+
+    // distances[u] and next_hops[u] are the distance from u to the destination and the neighbour of u that comes
+    // next on a shortest path to it
+    struct DestinationTree {
+        std::vector<size_t> distances;
+        std::vector<size_t> next_hops;
+    };
+
+    // Trees are published once with a compare-and-swap, so that concurrent solvers can share the network. Copies
+    // of a graph share them, as the physical network never changes
+    struct DestinationTrees {
+        explicit DestinationTrees(size_t n) : trees(new std::atomic<const DestinationTree *>[n]), size(n) {
+            for (size_t i = 0; i < n; ++i) {
+                trees[i].store(nullptr);
+            }
+        }
+        ~DestinationTrees() {
+            for (size_t i = 0; i < size; ++i) {
+                delete trees[i].load();
+            }
+        }
 
-    bool DFS(std::vector<size_t> &edge_path, std::vector<bool> &visited, size_t cur_v, size_t from, size_t to,
-             size_t bandwidth, const std::function<bool(const std::vector<size_t> &, size_t)> &is_path_ok) const;
+        std::unique_ptr<std::atomic<const DestinationTree *>[]> trees;
+        size_t size = 0;
+    };
+
+    const DestinationTree &GetDestinationTree(size_t destination) const;
+
+    // Builds the distance tables, or prepares the destination trees of a network larger than kMaxTableNodes
+    void PrepareDistances(DistancesAlgorithm distances_algorithm);
+
+    void Compact(size_t vertex);
+
+    void NextEpoch() const;
 
     size_t n_;
-    std::vector<std::unordered_set<std::pair<size_t, size_t>, boost::hash<std::pair<size_t, size_t>>>> adj_list_;
-    std::vector<std::vector<size_t>> distances_;
+
+    // The physical network is given once and never changes, so its adjacency is frozen in the CSR form
+    std::vector<size_t> csr_offsets_;
+    std::vector<size_t> csr_neighbours_;
+
+    // The virtual topology is edited all the time, so it keeps per-vertex slot arrays with O(1) AddEdge/RemoveEdge
+    std::vector<std::vector<Slot>> adj_list_;
+    std::vector<size_t> removed_slots_;
+    std::vector<EdgeSlots> edge_slots_;
+
+    // Row-major n x n matrices, only filled for a physical network. next_hops_[u * n + v] is the neighbour of u
+    // that comes next on a shortest path from u to v
+    std::vector<size_t> distances_;
+    std::vector<size_t> next_hops_;
+    std::shared_ptr<DestinationTrees> destination_trees_;
+
+    mutable size_t epoch_ = 0;
+    mutable std::vector<size_t> visited_;
+    mutable std::vector<SearchFrame> stack_;
 };
 
+
+template <class Policy>
+std::vector<size_t> Graph::GetPathEdges(size_t from, size_t to, size_t bandwidth, Policy &policy) const {
+    std::vector<size_t> path;
+    if (from == to) {
+        return path;
+    }
+
+    NextEpoch();
+    stack_.clear();
+
+    // Only searches long enough to matter are traced, with the number of expanded vertices
+    ScopedTrace trace("get_path_edges", Trace::kNoArg, 100'000);
+
+    // Counted locally and added once, so that the search loop does not touch the thread-local counters
+    uint64_t expansions = 1;
+    uint64_t rejections = 0;
+    auto count = [&](bool is_found) {
+        trace.SetArg(expansions);
+        CountStat(StatsCounter::kSearches);
+        CountStat(StatsCounter::kSearchExpansions, expansions);
+        CountStat(StatsCounter::kSearchRejections, rejections);
+        CountStat(StatsCounter::kPathsFound, is_found);
+    };
+
+    visited_[from] = epoch_;
+    stack_.push_back({from, 0});
+    while (!stack_.empty()) {
+        SearchFrame &frame = stack_.back();
+        const std::vector<Slot> &slots = adj_list_[frame.vertex];
+        if (frame.next == slots.size()) {
+            visited_[frame.vertex] = 0;
+            stack_.pop_back();
+            if (!stack_.empty()) {
+                policy.Pop(path.back());
+                path.pop_back();
+            }
+            continue;
+        }
+
+        auto [neighbour, edge_number] = slots[frame.next++];
+        if (edge_number == kRemoved || visited_[neighbour] == epoch_) {
+            continue;
+        }
+        if (!policy.Push(edge_number, bandwidth)) {
+            ++rejections;
+            continue;
+        }
+        path.push_back(edge_number);
+
+        if (neighbour == to) {
+            if (!policy.Accept(path)) {
+                policy.Pop(edge_number);
+                path.pop_back();
+                ++rejections;
+                continue;
+            }
+            for (auto it = path.rbegin(); it != path.rend(); ++it) {
+                policy.Pop(*it);
+            }
+            count(true);
+            return path;
+        }
+
+        visited_[neighbour] = epoch_;
+        stack_.push_back({neighbour, 0});
+        ++expansions;
+    }
+
+    count(false);
+    return path;
+}
+
+template <class Extend>
+void Graph::GetReachableVertices(size_t from, const Extend &extend, std::vector<size_t> &reached,
+                                 std::vector<size_t> &parent_edges) const {
+    NextEpoch();
+    reached.clear();
+    parent_edges.resize(n_);
+
+    visited_[from] = epoch_;
+    reached.push_back(from);
+    for (size_t i = 0; i < reached.size(); ++i) {
+        size_t vertex = reached[i];
+        for (auto [neighbour, edge_number]: adj_list_[vertex]) {
+            if (edge_number == kRemoved || visited_[neighbour] == epoch_ || !extend(vertex, neighbour, edge_number)) {
+                continue;
+            }
+            visited_[neighbour] = epoch_;
+            parent_edges[neighbour] = edge_number;
+            reached.push_back(neighbour);
+        }
+    }
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "graph.h"
+#include "span.h"
+#include "structures.h"
+
+// Binary instance file: a header followed by the edges and the demands as arrays of little-endian 64-bit words,
+// laid out exactly as Edge and TrafficDemand, so that a mapped file is used without parsing
+struct InstanceHeader {
+    static constexpr char kMagic[8] = {'G', 'R', 'A', 'S', 'P', '4', 'I', '\0'};
+    static constexpr uint64_t kVersion = 1;
+
+    char magic[8];
+    uint64_t version;
+    uint64_t nodes_number;
+    uint64_t lightpath_bandwidth;
+    uint64_t edges_number;
+    uint64_t demands_number;
+    uint64_t edges_offset;
+    uint64_t demands_offset;
+};
+
+// A binary instance file mapped into memory. The edges and demands views stay valid while the file is open
+class InstanceFile {
+public:
+    InstanceFile() = default;
+    ~InstanceFile();
+
+    InstanceFile(const InstanceFile &) = delete;
+    InstanceFile &operator=(const InstanceFile &) = delete;
+
+    // Maps the file and checks its header and that all node ids are in range. On failure returns false and
+    // describes the problem in error
+    bool Open(const std::string &path, std::string &error);
+
+    void Close();
+
+    size_t GetNodesNumber() const;
+    size_t GetLightpathBandwidth() const;
+    Span<Edge> GetEdges() const;
+    Span<TrafficDemand> GetDemands() const;
+
+    static bool Write(const std::string &path, size_t n, size_t lightpath_bandwidth, Span<Edge> edges,
+                      Span<TrafficDemand> demands, std::string &error);
+
+private:
+    const void *data_ = nullptr;
+    size_t size_ = 0;
+    const InstanceHeader *header_ = nullptr;
+};
+
+// Text instance format, '#' starts a comment:
+//     n edges_number demands_number lightpath_bandwidth
+//     source destination                  (edges_number lines)
+//     source destination bandwidth        (demands_number lines)
+bool ReadTextInstance(const std::string &path, size_t &n, size_t &lightpath_bandwidth, std::vector<Edge> &edges,
+                      std::vector<TrafficDemand> &demands, std::string &error);
+
+bool ConvertTextInstance(const std::string &text_path, const std::string &binary_path, std::string &error);
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <vector>
+
+#include "structures.h"
+
+// Combinatorial lower bounds on the number of lightpaths of any solution. Every bound only uses the demands
+// and the lightpath bandwidth, so it is valid whatever the physical network is
+class LowerBound {
+public:
+    LowerBound(size_t n, size_t lightpath_bandwidth, const std::vector<TrafficDemand> &traffic_demands);
+
+    // Recomputes the bound after the demands have changed
+    void Update();
+
+    size_t Get() const;
+
+    // Relative distance of a solution from the bound, 0 means the solution is provably optimal
+    double Gap(size_t lightpaths_number) const;
+
+private:
+    // Lightpaths ending at a node must carry all the traffic of demands ending there, and every lightpath
+    // has at most two endpoints
+    size_t NodesBound() const;
+
+    // Every demand uses at least one lightpath, so all lightpaths together carry at least the total traffic
+    size_t TotalBandwidthBound() const;
+
+    // The virtual topology has to connect the endpoints of every demand, so every connected component
+    // of the demands graph needs at least a spanning tree of lightpaths
+    size_t ConnectivityBound() const;
+
+    size_t n_;
+    size_t lightpath_bandwidth_;
+    const std::vector<TrafficDemand> &traffic_demands_;
+
+    size_t bound_;
+};
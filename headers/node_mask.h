@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// A set of physical nodes stored as a bitset of NodeMaskWords(n) 64-bit words. The loops over words have no early
+// exit, so that the compiler can vectorize them. The same helpers serve for sets of lightpaths
+
+inline size_t NodeMaskWords(size_t n) {
+    return (n + 63) / 64;
+}
+
+inline void SetNode(uint64_t *mask, size_t node) {
+    mask[node / 64] |= uint64_t(1) << (node % 64);
+}
+
+inline bool HasNode(const uint64_t *mask, size_t node) {
+    return (mask[node / 64] >> (node % 64)) & 1;
+}
+
+inline bool Intersects(const uint64_t *__restrict left, const uint64_t *__restrict right, size_t words) {
+    uint64_t common = 0;
+    for (size_t i = 0; i < words; ++i) {
+        common |= left[i] & right[i];
+    }
+    return common != 0;
+}
+
+inline void Include(uint64_t *__restrict mask, const uint64_t *__restrict other, size_t words) {
+    for (size_t i = 0; i < words; ++i) {
+        mask[i] |= other[i];
+    }
+}
+
+inline void Exclude(uint64_t *__restrict mask, const uint64_t *__restrict other, size_t words) {
+    for (size_t i = 0; i < words; ++i) {
+        mask[i] &= ~other[i];
+    }
+}
+
+inline bool IsSubset(const uint64_t *__restrict mask, const uint64_t *__restrict other, size_t words) {
+    uint64_t extra = 0;
+    for (size_t i = 0; i < words; ++i) {
+        extra |= mask[i] & ~other[i];
+    }
+    return extra == 0;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "graph.h"
+#include "lower_bound.h"
+#include "run_config.h"
+#include "stats.h"
+#include "structures.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+class ParallelAlgorithm {
+public:
+    ParallelAlgorithm(size_t n, size_t m, size_t lightpath_bandwidth, const std::vector<TrafficDemand> &traffic_demands,
+                      const Graph &network, size_t starts_number,
+                      size_t workers_number = std::thread::hardware_concurrency());
+
+    // The time budget and the cancellation token apply to the whole run, the other rules to every chain.
+    // Reaching the target lightpaths number or the lower bound in any chain stops all of them. As in
+    // Algorithm::Run, the first construction is always completed, so the result routes every demand
+    Solution Run(const RunConfig &config = RunConfig());
+
+    const LowerBound &GetLowerBound() const;
+
+    // Counters and timers of the last Run() summed over all chains, only collected in a build with GRASP4_STATS
+    const SolverStats &GetStats() const;
+
+private:
+    void Work();
+
+    void Publish(const Solution &solution);
+
+    // Saves the best solution to the checkpoint file of the config, called with the best solution locked
+    void Checkpoint();
+
+private:
+    size_t n_;
+    size_t m_;
+    size_t lightpath_bandwidth_;
+    size_t starts_number_;
+    size_t workers_number_;
+
+    const std::vector<TrafficDemand> &traffic_demands_;
+    const Graph &network_;
+
+    LowerBound lower_bound_;
+
+    std::atomic<size_t> next_start_;
+
+    const RunConfig *config_ = nullptr;
+    CancellationToken *stop_ = nullptr;
+    std::chrono::steady_clock::time_point deadline_;
+
+    std::mutex best_solution_mutex_;
+    Solution best_solution_;
+    SolverStats stats_;
+    std::chrono::steady_clock::time_point last_checkpoint_;
+    bool is_checkpointed_ = true;
+};
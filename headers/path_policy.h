@@ -0,0 +1,70 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "node_mask.h"
+#include "structures.h"
+
+// Feasibility policies of Graph::GetPathEdges over the lightpaths of a solution. Push is asked before a lightpath
+// joins the path prefix and may reject it, Pop is called when an accepted lightpath leaves the prefix, and Accept
+// has the last word on a complete path. The search is instantiated for every policy, so the checks are inlined into
+// its loop and a caller only pays for the checks it asks for
+template <bool kCheckBandwidth, bool kCheckSimple>
+class LightpathPolicy {
+public:
+    explicit LightpathPolicy(const Solution &solution) : solution_(solution), path_mask_(solution.mask_words_, 0) {
+    }
+
+    bool Push(size_t lp_id, size_t bandwidth) {
+        if constexpr (kCheckBandwidth) {
+            if (solution_.unused_bandwidth[lp_id] < bandwidth) {
+                return false;
+            }
+        }
+
+        // As in the physical path of a demand consecutive lightpaths share their endpoints, a lightpath mask holds
+        // all its nodes but the first one, and the first node is only taken into account for the first lightpath
+        if constexpr (kCheckSimple) {
+            const uint64_t *mask = solution_.LightpathMask(lp_id);
+            if (path_length_ == 0) {
+                size_t source = solution_.lightpaths_[lp_id].source;
+                if (HasNode(mask, source)) {
+                    return false;
+                }
+                SetNode(path_mask_.data(), source);
+            } else if (Intersects(path_mask_.data(), mask, path_mask_.size())) {
+                return false;
+            }
+            Include(path_mask_.data(), mask, path_mask_.size());
+            ++path_length_;
+        }
+
+        return true;
+    }
+
+    void Pop(size_t lp_id) {
+        if constexpr (kCheckSimple) {
+            if (--path_length_ == 0) {
+                std::fill(path_mask_.begin(), path_mask_.end(), 0);
+            } else {
+                Exclude(path_mask_.data(), solution_.LightpathMask(lp_id), path_mask_.size());
+            }
+        }
+    }
+
+    bool Accept(const std::vector<size_t> &) const {
+        return true;
+    }
+
+private:
+    const Solution &solution_;
+
+    // Physical nodes occupied by the lightpaths of the prefix accepted so far
+    std::vector<uint64_t> path_mask_;
+    size_t path_length_ = 0;
+};
+
+using BandwidthPolicy = LightpathPolicy<true, false>;
+using SimplePathPolicy = LightpathPolicy<false, true>;
+using FeasiblePathPolicy = LightpathPolicy<true, true>;
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include "structures.h"
+
+// Cooperative stop flag shared between a running solver and its caller. A token linked to a parent
+// is also cancelled when the parent is
+class CancellationToken {
+public:
+    explicit CancellationToken(const CancellationToken *parent = nullptr) : parent_(parent) {
+    }
+
+    void Cancel() {
+        cancelled_.store(true, std::memory_order_relaxed);
+    }
+
+    bool IsCancelled() const {
+        return cancelled_.load(std::memory_order_relaxed) || (parent_ != nullptr && parent_->IsCancelled());
+    }
+
+private:
+    std::atomic<bool> cancelled_ = false;
+    const CancellationToken *parent_;
+};
+
+// Stopping rules of a run, whichever comes first. The defaults reproduce the original rule of stopping after
+// four consecutive iterations without improvement
+struct RunConfig {
+    std::chrono::steady_clock::duration time_budget = std::chrono::steady_clock::duration::max();
+    size_t max_iterations = SIZE_MAX;
+    size_t max_no_changes_iterations = 4;
+    size_t target_lightpaths_number = 0;
+    const CancellationToken *cancellation_token = nullptr;
+
+    // With more than one worker, LightpathMin evaluates that many lightpath removals at once on copies of the
+    // solution, and commits them in priority order so that the result is the one of the serial pass
+    size_t speculative_workers = 1;
+
+    // With a non-zero size, the local optimum of every iteration is offered to a pool of that many elite solutions,
+    // kept both good and diverse, and is then relinked with the best member: its demands are moved onto their paths
+    // in the member, and the best solution on the way is improved by LightpathMin
+    size_t elite_pool_size = 0;
+
+    // When set, the best solution is saved to this file once it has improved and checkpoint_interval has passed
+    // since the last save, and at the end of the run if it improved since then
+    std::string checkpoint_path;
+    std::chrono::steady_clock::duration checkpoint_interval = std::chrono::seconds(30);
+
+    // Called with every new best solution as soon as it is found
+    std::function<void(const Solution &)> on_incumbent;
+};
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "graph.h"
+#include "structures.h"
+
+// Binary solution file: a header followed by arrays of little-endian 64-bit words. Lightpaths, residuals and the
+// lightpaths of every demand are stored by index, the virtual topology being the used lightpaths
+struct SolutionHeader {
+    static constexpr char kMagic[8] = {'G', 'R', 'A', 'S', 'P', '4', 'S', '\0'};
+    static constexpr uint64_t kVersion = 1;
+
+    char magic[8];
+    uint64_t version;
+    uint64_t mask_words;
+    uint64_t lightpaths_number;
+    uint64_t lightpaths_size;
+    uint64_t nodes_pool_size;
+    uint64_t demands_number;
+    uint64_t assignments_number;
+};
+
+// The file is first written next to path and then renamed over it, so that an interrupted save never leaves a
+// truncated checkpoint behind
+bool SaveSolution(const std::string &path, const Solution &solution, std::string &error);
+
+// Loads a solution of an instance of n nodes: checks that its masks are sized for n nodes and that every index is in
+// range, and rebuilds the node masks and the demands of every lightpath. On failure returns false and describes the
+// problem in error
+bool LoadSolution(const std::string &path, size_t n, Solution &solution, std::string &error);
+
+// Checks that a loaded solution belongs to an instance of n nodes and m demands over the network: every lightpath has
+// at least two nodes below n, and every two consecutive ones are linked. On failure returns false and describes the
+// problem in error
+bool CheckSolution(const Solution &solution, size_t n, size_t m, const Graph &network, std::string &error);
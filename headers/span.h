@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Read-only view of an array that lives somewhere else, e.g. in a memory-mapped file
+template <class T>
+class Span {
+public:
+    Span() = default;
+    Span(const T *data, size_t size) : data_(data), size_(size) {
+    }
+    // Implicit, so that a vector can be passed wherever a span is expected
+    Span(const std::vector<T> &vector) : data_(vector.data()), size_(vector.size()) {
+    }
+
+    const T *begin() const {
+        return data_;
+    }
+    const T *end() const {
+        return data_ + size_;
+    }
+    const T &operator[](size_t i) const {
+        return data_[i];
+    }
+    size_t size() const {
+        return size_;
+    }
+
+private:
+    const T *data_ = nullptr;
+    size_t size_ = 0;
+};
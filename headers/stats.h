@@ -0,0 +1,117 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+// Solver statistics are only collected when the build defines GRASP4_STATS=1 (the GRASP4_STATS CMake option).
+// Otherwise every counter and timer below compiles to nothing
+#ifndef GRASP4_STATS
+#define GRASP4_STATS 0
+#endif
+
+constexpr bool kStatsEnabled = GRASP4_STATS;
+
+enum class StatsCounter {
+    kSearches,
+    kSearchExpansions,
+    kSearchRejections,
+    kPathsFound,
+    kNewLightpaths,
+    kGroomingAttempts,
+    kGroomingSuccesses,
+    kNogoodHits,
+    kCountersNumber,
+};
+
+enum class StatsTimer {
+    kRun,
+    kConstruct,
+    kLightpathMin,
+    kTimersNumber,
+};
+
+constexpr size_t kStatsCountersNumber = static_cast<size_t>(StatsCounter::kCountersNumber);
+constexpr size_t kStatsTimersNumber = static_cast<size_t>(StatsTimer::kTimersNumber);
+
+// Counters and timer totals of one thread, or a difference or sum of such
+struct StatsCounters {
+    uint64_t counters[kStatsCountersNumber] = {};
+    uint64_t timers_ns[kStatsTimersNumber] = {};
+
+    uint64_t Get(StatsCounter counter) const {
+        return counters[static_cast<size_t>(counter)];
+    }
+
+    uint64_t GetNanoseconds(StatsTimer timer) const {
+        return timers_ns[static_cast<size_t>(timer)];
+    }
+
+    StatsCounters &operator+=(const StatsCounters &other) {
+        for (size_t i = 0; i < kStatsCountersNumber; ++i) {
+            counters[i] += other.counters[i];
+        }
+        for (size_t i = 0; i < kStatsTimersNumber; ++i) {
+            timers_ns[i] += other.timers_ns[i];
+        }
+        return *this;
+    }
+
+    StatsCounters &operator-=(const StatsCounters &other) {
+        for (size_t i = 0; i < kStatsCountersNumber; ++i) {
+            counters[i] -= other.counters[i];
+        }
+        for (size_t i = 0; i < kStatsTimersNumber; ++i) {
+            timers_ns[i] -= other.timers_ns[i];
+        }
+        return *this;
+    }
+};
+
+// Statistics of a run: what its threads counted while it ran, and the lightpaths number of every iteration. The
+// latter is kept even without GRASP4_STATS, as it costs one entry per iteration
+struct SolverStats {
+    StatsCounters counters;
+    std::vector<size_t> iterations_lightpaths;
+
+    void PrintJson(std::ostream &out) const;
+};
+
+// The counters of the calling thread. Every thread only ever touches its own, so counting needs no atomics,
+// and a run reports the difference between the counters at its end and at its start
+inline StatsCounters &ThreadStatsCounters() {
+    thread_local StatsCounters counters;
+    return counters;
+}
+
+inline void CountStat(StatsCounter counter, uint64_t value = 1) {
+    if constexpr (kStatsEnabled) {
+        ThreadStatsCounters().counters[static_cast<size_t>(counter)] += value;
+    }
+}
+
+// Adds the time from its construction to its destruction to the timer of the calling thread
+class ScopedStatsTimer {
+public:
+    explicit ScopedStatsTimer(StatsTimer timer) : timer_(timer) {
+        if constexpr (kStatsEnabled) {
+            start_ = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~ScopedStatsTimer() {
+        if constexpr (kStatsEnabled) {
+            auto elapsed = std::chrono::steady_clock::now() - start_;
+            ThreadStatsCounters().timers_ns[static_cast<size_t>(timer_)] +=
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+        }
+    }
+
+    ScopedStatsTimer(const ScopedStatsTimer &) = delete;
+    ScopedStatsTimer &operator=(const ScopedStatsTimer &) = delete;
+
+private:
+    StatsTimer timer_;
+    std::chrono::steady_clock::time_point start_;
+};
@@ -1,8 +1,9 @@
 #pragma once
 
+#include <algorithm>
 #include <vector>
-#include <unordered_map>
-#include <unordered_set>
+
+#include "node_mask.h"
 
 struct TrafficDemand {
     TrafficDemand() = default;
@@ -15,56 +16,138 @@ struct TrafficDemand {
     size_t bandwidth = 0;
 };
 
+// The nodes of a lightpath live in the nodes pool of its solution, the lightpath only knows where they are
 struct Lightpath {
-    Lightpath() = default;
-    Lightpath(size_t bandwidth, std::vector<size_t> nodes) : unused_bandwidth(bandwidth), nodes(std::move(nodes)) {
-    }
-
-    size_t unused_bandwidth = 0;
-    std::vector<size_t> nodes;
+    size_t source = 0;
+    size_t destination = 0;
+    size_t nodes_offset = 0;
+    size_t nodes_number = 0;
 };
 
+// Demands are identified by their index in the demands vector, lightpaths by their index in lightpaths_.
+// Per-lightpath data is kept in parallel arrays, so copying a solution copies a few flat buffers
+// instead of rehashing pointer-keyed containers
 struct Solution {
+    explicit Solution(size_t n = 0, size_t m = 0) : mask_words_(NodeMaskWords(n)), demand_lightpaths(m) {
+    }
+
     size_t lightpaths_number_ = 0;
     std::vector<Lightpath> lightpaths_;
+
+    // Nodes of all lightpaths one after another, and for every lightpath the mask of its nodes except the first one
+    size_t mask_words_ = 0;
+    std::vector<size_t> nodes_pool_;
+    std::vector<uint64_t> masks_pool_;
+
+    std::vector<size_t> unused_bandwidth;
     std::vector<bool> use_of_lightpaths;
-    std::unordered_map<const TrafficDemand *, std::vector<size_t>> demand_lightpaths;
-    std::vector<std::unordered_set<const TrafficDemand *>> lightpath_demands;
+    std::vector<std::vector<size_t>> demand_lightpaths;
+    std::vector<std::vector<size_t>> lightpath_demands;
 
-    void Assign(const TrafficDemand *demand_ptr, const std::vector<size_t> &lightpaths_idxes) {
-        for (size_t lp_id: lightpaths_idxes) {
-            if (lp_id >= use_of_lightpaths.size()) {
-                use_of_lightpaths.push_back(false);
-                lightpath_demands.emplace_back();
+    // Between Checkpoint() and Commit()/Rollback() every Assign and Unassign is recorded, so that a rollback
+    // only undoes what was touched instead of restoring a full copy of the solution
+    struct JournalEntry {
+        size_t demand_id;
+        size_t bandwidth;
+        bool assigned;
+        std::vector<size_t> lightpaths_idxes;
+    };
+
+    bool journaling_ = false;
+    std::vector<JournalEntry> journal_;
+
+    void Checkpoint() {
+        journal_.clear();
+        journaling_ = true;
+    }
+
+    void Commit() {
+        journal_.clear();
+        journaling_ = false;
+    }
+
+    void Rollback() {
+        journaling_ = false;
+        for (auto it = journal_.rbegin(); it != journal_.rend(); ++it) {
+            if (it->assigned) {
+                Unassign(it->demand_id, it->bandwidth);
+            } else {
+                Assign(it->demand_id, it->bandwidth, it->lightpaths_idxes);
             }
+        }
+        journal_.clear();
+    }
+
+    const size_t *LightpathNodes(size_t lp_id) const {
+        return nodes_pool_.data() + lightpaths_[lp_id].nodes_offset;
+    }
+
+    const uint64_t *LightpathMask(size_t lp_id) const {
+        return masks_pool_.data() + lp_id * mask_words_;
+    }
+
+    size_t AddLightpath(size_t bandwidth, const std::vector<size_t> &nodes) {
+        Lightpath &lightpath = lightpaths_.emplace_back();
+        lightpath.nodes_offset = nodes_pool_.size();
+        lightpath.nodes_number = nodes.size();
+        if (!nodes.empty()) {
+            lightpath.source = nodes.front();
+            lightpath.destination = nodes.back();
+        }
+        nodes_pool_.insert(nodes_pool_.end(), nodes.begin(), nodes.end());
+
+        masks_pool_.resize(masks_pool_.size() + mask_words_, 0);
+        uint64_t *mask = masks_pool_.data() + (lightpaths_.size() - 1) * mask_words_;
+        for (size_t i = 1; i < nodes.size(); ++i) {
+            SetNode(mask, nodes[i]);
+        }
+
+        unused_bandwidth.push_back(bandwidth);
+        use_of_lightpaths.push_back(false);
+        lightpath_demands.emplace_back();
+        return lightpaths_.size() - 1;
+    }
+
+    void Assign(size_t demand_id, size_t bandwidth, const std::vector<size_t> &lightpaths_idxes) {
+        if (journaling_) {
+            journal_.push_back({demand_id, bandwidth, true, {}});
+        }
+        for (size_t lp_id: lightpaths_idxes) {
             if (!use_of_lightpaths[lp_id]) {
                 use_of_lightpaths[lp_id] = true;
                 ++lightpaths_number_;
             }
-            lightpaths_[lp_id].unused_bandwidth -= demand_ptr->bandwidth;
-            lightpath_demands[lp_id].insert(demand_ptr);
+            unused_bandwidth[lp_id] -= bandwidth;
+            lightpath_demands[lp_id].push_back(demand_id);
         }
-        demand_lightpaths[demand_ptr] = lightpaths_idxes;
+        demand_lightpaths[demand_id] = lightpaths_idxes;
     }
 
-    void Unassign(const TrafficDemand *demand_ptr) {
-        for (size_t lp_id: demand_lightpaths[demand_ptr]) {
-            lightpaths_[lp_id].unused_bandwidth += demand_ptr->bandwidth;
-            lightpath_demands[lp_id].erase(demand_ptr);
-            if (lightpath_demands[lp_id].empty()) {
+    void Unassign(size_t demand_id, size_t bandwidth) {
+        std::vector<size_t> &lightpaths_idxes = demand_lightpaths[demand_id];
+        for (size_t lp_id: lightpaths_idxes) {
+            unused_bandwidth[lp_id] += bandwidth;
+
+            std::vector<size_t> &demands = lightpath_demands[lp_id];
+            *std::find(demands.begin(), demands.end(), demand_id) = demands.back();
+            demands.pop_back();
+            if (demands.empty()) {
                 use_of_lightpaths[lp_id] = false;
                 --lightpaths_number_;
             }
         }
-        demand_lightpaths[demand_ptr].clear();
+        if (journaling_) {
+            journal_.push_back({demand_id, bandwidth, false, std::move(lightpaths_idxes)});
+        }
+        lightpaths_idxes.clear();
     }
 
     void Reset(size_t lightpath_bandwidth) {
         lightpaths_number_ = 0;
-        for (size_t lp_id = 0; lp_id < lightpaths_.size(); ++lp_id) {
-            lightpaths_[lp_id].unused_bandwidth = lightpath_bandwidth;
-            use_of_lightpaths[lp_id] = false;
-            lightpath_demands[lp_id].clear();
+        std::fill(unused_bandwidth.begin(), unused_bandwidth.end(), lightpath_bandwidth);
+        std::fill(use_of_lightpaths.begin(), use_of_lightpaths.end(), false);
+        for (std::vector<size_t> &demands: lightpath_demands) {
+            demands.clear();
         }
     }
 };
\ No newline at end of file
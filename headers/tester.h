@@ -1,19 +1,34 @@
 #pragma once
 
 #include <cstdlib>
+#include <string>
 #include <utility>
+#include <vector>
+
+#include "graph.h"
+#include "structures.h"
 
 class Tester {
 public:
     Tester() = default;
 
     static void RandomTests();
+    static void ViolationTests();
     static void RingTests();
     static void MeshTests();
+    static void ParallelTests();
+    static void OnlineTests();
+    static void ReplayTests();
+    static void CheckpointTests();
+    static void InstanceFileTests();
+    static void TopologyTests();
+    static void AggregationTests();
+    static void ElitePoolTests();
 
 private:
     static void RandomTest(size_t n, size_t m, size_t loops_number);
     static void RandomValidationTest(size_t n, size_t m);
+    static void ViolationTest(size_t n, size_t m);
 
     static void RingOneTest();
     static void RingTwoTest();
@@ -24,4 +39,26 @@ private:
     static void MeshFourTest();
     static void MeshFiveTest();
     static void MeshSixTest();
+
+    static void ParallelTest(const std::string &name, size_t n, size_t m, size_t lightpath_bandwidth,
+                             const std::vector<std::vector<size_t>> &adj_matrix,
+                             const std::vector<TrafficDemand> &demands);
+
+    static void OnlineTest(size_t n, size_t m);
+
+    static void ReplayTest(size_t n, size_t m, size_t epochs_number, double drift);
+
+    static void CheckpointTest(size_t n, size_t m);
+
+    static void InstanceFileTest(size_t n, size_t m);
+
+    static void TopologyTest(const std::string &name, size_t n, size_t m, const std::vector<Edge> &edges,
+                             const std::vector<TrafficDemand> &demands);
+
+    static void AggregationTest(size_t n, size_t m);
+
+    static void ElitePoolTest(size_t instance, size_t m);
+
+    // Number of lightpaths set up or torn down between two solutions, lightpaths are compared by their nodes
+    static size_t LightpathsChurn(const Solution &previous_solution, const Solution &solution);
 };
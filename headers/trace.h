@@ -0,0 +1,73 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Timeline tracing is only compiled in when the build defines GRASP4_TRACE=1 (the GRASP4_TRACE CMake option).
+// Otherwise ScopedTrace compiles to nothing
+#ifndef GRASP4_TRACE
+#define GRASP4_TRACE 0
+#endif
+
+constexpr bool kTraceEnabled = GRASP4_TRACE;
+
+// A complete event of the Chrome trace format. The name must be a string literal
+struct TraceEvent {
+    const char *name;
+    uint64_t start_ns;
+    uint64_t duration_ns;
+    uint64_t arg;
+    uint64_t thread_id;
+};
+
+// Every thread records into a ring buffer of its own, which keeps the last kCapacity events. Only the owner
+// writes to a buffer, so recording takes no lock; the buffer of a finished thread is handed to the next new thread
+class Trace {
+public:
+    static constexpr size_t kCapacity = size_t(1) << 15;
+    static constexpr uint64_t kNoArg = UINT64_MAX;
+
+    static uint64_t Now();
+
+    static void Record(const char *name, uint64_t start_ns, uint64_t duration_ns, uint64_t arg);
+
+    // Drops all recorded events. Like WriteJson, must not run while other threads are recording
+    static void Clear();
+
+    // Writes the recorded events as Chrome trace_event JSON, which Perfetto and chrome://tracing open
+    static bool WriteJson(const std::string &path, std::string &error);
+};
+
+// Records the time from its construction to its destruction as one event, if it lasted at least min_duration_ns
+class ScopedTrace {
+public:
+    explicit ScopedTrace(const char *name, uint64_t arg = Trace::kNoArg, uint64_t min_duration_ns = 0)
+            : name_(name), arg_(arg), min_duration_ns_(min_duration_ns) {
+        if constexpr (kTraceEnabled) {
+            start_ns_ = Trace::Now();
+        }
+    }
+
+    ~ScopedTrace() {
+        if constexpr (kTraceEnabled) {
+            uint64_t duration_ns = Trace::Now() - start_ns_;
+            if (duration_ns >= min_duration_ns_) {
+                Trace::Record(name_, start_ns_, duration_ns, arg_);
+            }
+        }
+    }
+
+    ScopedTrace(const ScopedTrace &) = delete;
+    ScopedTrace &operator=(const ScopedTrace &) = delete;
+
+    void SetArg(uint64_t arg) {
+        arg_ = arg;
+    }
+
+private:
+    const char *name_;
+    uint64_t arg_;
+    uint64_t min_duration_ns_;
+    uint64_t start_ns_ = 0;
+};
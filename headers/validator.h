@@ -3,21 +3,68 @@
 #include "graph.h"
 #include "structures.h"
 
+#include <string>
+#include <thread>
+
+enum class Violation {
+    kNone,
+    kMissingPath,
+    kUnknownLightpath,
+    kDisconnectedPath,
+    kNotSimplePath,
+    kOverloadedLightpath,
+    kWrongResidual,
+    kWrongUse,
+    kWrongLightpathsNumber,
+    kMissingLink,
+};
+
+// The constraint a solution breaks, and the demand and the lightpath it is broken at, where they apply
+struct ValidationFailure {
+    Violation violation = Violation::kNone;
+    size_t demand_id = SIZE_MAX;
+    size_t lp_id = SIZE_MAX;
+
+    std::string Describe() const;
+};
+
 class Validator {
 public:
     Validator(size_t n, size_t m, size_t lightpath_bandwidth, const Solution &solution, const Graph &network,
-              const std::vector<TrafficDemand> &demands);
+              const std::vector<TrafficDemand> &demands,
+              size_t workers_number = std::thread::hardware_concurrency());
 
     bool Validate() const;
 
+    // Checks the demands paths in parallel chunks and recomputes the load of every lightpath from them, instead of
+    // trusting the residuals kept by the solution. Stops at the first violation found and describes it in failure
+    bool Validate(ValidationFailure &failure) const;
+
+    // A path of lightpaths is simple if no physical node is visited twice
+    bool IsSimple(const std::vector<size_t> &path) const;
+
 private:
-    void ConstructMatrices(const Solution &solution, const std::vector<Lightpath> &lightpaths);
+    static constexpr size_t kChunkSize = 1024;
+
+    // Scratch of one worker: the nodes of the path being checked, and the load and the demands number of every
+    // lightpath over the paths checked by the worker
+    struct Scratch {
+        std::vector<uint64_t> path_mask;
+        std::vector<size_t> loads;
+        std::vector<size_t> uses;
+    };
+
+    Violation CheckPath(size_t demand_id, Scratch &scratch, size_t &lp_id) const;
+
+    // Whether every two consecutive nodes of the lightpath are linked in the network
+    bool HasLinks(size_t lp_id) const;
 
     size_t n_;
     size_t m_;
     size_t l_;
 
     size_t lightpath_bandwidth_;
+    size_t workers_number_;
 
     const Solution &solution_;
     const std::vector<TrafficDemand> &demands_;
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Threads started once that run batches of tasks, so that short parallel phases do not create and join threads
+// every time. Task i of a batch always runs on the same thread, the calling thread for task 0 and worker i for the
+// others, so per-thread state such as statistics and trace buffers stays with it
+class WorkerPool {
+public:
+    // workers_number counts the calling thread
+    explicit WorkerPool(size_t workers_number);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool &) = delete;
+    WorkerPool &operator=(const WorkerPool &) = delete;
+
+    size_t GetWorkersNumber() const;
+
+    // Runs task(i) for every i in [0, tasks_number) and returns once all are done, tasks_number is at most the
+    // workers number
+    void Run(size_t tasks_number, const std::function<void(size_t)> &task);
+
+private:
+    void Work(size_t worker);
+
+    std::vector<std::thread> threads_;
+
+    std::mutex mutex_;
+    std::condition_variable batch_started_;
+    std::condition_variable batch_finished_;
+    const std::function<void(size_t)> *task_ = nullptr;
+    size_t tasks_number_ = 0;
+    size_t batch_number_ = 0;
+    size_t pending_tasks_number_ = 0;
+    bool is_stopping_ = false;
+};
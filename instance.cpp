@@ -0,0 +1,214 @@
+#include "headers/instance.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static_assert(sizeof(size_t) == sizeof(uint64_t), "The binary instance format needs 64-bit size_t");
+static_assert(sizeof(Edge) == 2 * sizeof(uint64_t), "Edge must match its binary layout");
+static_assert(sizeof(TrafficDemand) == 3 * sizeof(uint64_t), "TrafficDemand must match its binary layout");
+static_assert(sizeof(InstanceHeader) == 64, "InstanceHeader must match its binary layout");
+
+// Root of the component of node in a disjoint-set forest, halving the path on the way
+static size_t FindRoot(std::vector<size_t> &parents, size_t node) {
+    while (parents[node] != node) {
+        parents[node] = parents[parents[node]];
+        node = parents[node];
+    }
+    return node;
+}
+
+InstanceFile::~InstanceFile() {
+    Close();
+}
+
+bool InstanceFile::Open(const std::string &path, std::string &error) {
+    Close();
+    error.clear();
+
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd == -1) {
+        error = "cannot open " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    struct stat file_stat {};
+    if (fstat(fd, &file_stat) == -1 || static_cast<size_t>(file_stat.st_size) < sizeof(InstanceHeader)) {
+        close(fd);
+        error = path + " is too small to be an instance file";
+        return false;
+    }
+
+    size_ = file_stat.st_size;
+    void *data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        size_ = 0;
+        error = "cannot map " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    data_ = data;
+    header_ = static_cast<const InstanceHeader *>(data_);
+
+    // The arrays are checked to lie inside the file before any of them is read
+    const InstanceHeader &header = *header_;
+    auto fits = [this](uint64_t offset, uint64_t number, uint64_t element_size) {
+        return offset % alignof(uint64_t) == 0 && offset <= size_ && number <= (size_ - offset) / element_size;
+    };
+    if (std::memcmp(header.magic, InstanceHeader::kMagic, sizeof(header.magic)) != 0) {
+        error = path + " is not an instance file";
+    } else if (header.version != InstanceHeader::kVersion) {
+        error = path + " has unsupported version " + std::to_string(header.version);
+    } else if (header.lightpath_bandwidth == 0) {
+        error = path + " has lightpaths of zero bandwidth";
+    } else if (!fits(header.edges_offset, header.edges_number, sizeof(Edge)) ||
+               !fits(header.demands_offset, header.demands_number, sizeof(TrafficDemand))) {
+        error = path + " is truncated";
+    } else {
+        for (const Edge &edge: GetEdges()) {
+            if (edge.source >= header.nodes_number || edge.destination >= header.nodes_number) {
+                error = path + " has an edge with a node out of range";
+                break;
+            }
+        }
+        for (const TrafficDemand &demand: GetDemands()) {
+            if (demand.source >= header.nodes_number || demand.destination >= header.nodes_number ||
+                demand.source == demand.destination || demand.bandwidth > header.lightpath_bandwidth) {
+                error = path + " has an invalid demand";
+                break;
+            }
+        }
+        if (error.empty()) {
+            // A demand whose endpoints are in different components of the network could never be routed
+            std::vector<size_t> parents(header.nodes_number);
+            for (size_t node = 0; node < parents.size(); ++node) {
+                parents[node] = node;
+            }
+            for (const Edge &edge: GetEdges()) {
+                parents[FindRoot(parents, edge.source)] = FindRoot(parents, edge.destination);
+            }
+            for (size_t demand_id = 0; demand_id < header.demands_number; ++demand_id) {
+                const TrafficDemand &demand = GetDemands()[demand_id];
+                if (FindRoot(parents, demand.source) != FindRoot(parents, demand.destination)) {
+                    error = path + " has demand " + std::to_string(demand_id) +
+                            " between nodes that are disconnected in the network";
+                    break;
+                }
+            }
+        }
+        if (error.empty()) {
+            return true;
+        }
+    }
+
+    Close();
+    return false;
+}
+
+void InstanceFile::Close() {
+    if (data_ != nullptr) {
+        munmap(const_cast<void *>(data_), size_);
+    }
+    data_ = nullptr;
+    size_ = 0;
+    header_ = nullptr;
+}
+
+size_t InstanceFile::GetNodesNumber() const {
+    return header_->nodes_number;
+}
+
+size_t InstanceFile::GetLightpathBandwidth() const {
+    return header_->lightpath_bandwidth;
+}
+
+Span<Edge> InstanceFile::GetEdges() const {
+    return {reinterpret_cast<const Edge *>(static_cast<const char *>(data_) + header_->edges_offset),
+            header_->edges_number};
+}
+
+Span<TrafficDemand> InstanceFile::GetDemands() const {
+    return {reinterpret_cast<const TrafficDemand *>(static_cast<const char *>(data_) + header_->demands_offset),
+            header_->demands_number};
+}
+
+bool InstanceFile::Write(const std::string &path, size_t n, size_t lightpath_bandwidth, Span<Edge> edges,
+                         Span<TrafficDemand> demands, std::string &error) {
+    InstanceHeader header{};
+    std::memcpy(header.magic, InstanceHeader::kMagic, sizeof(header.magic));
+    header.version = InstanceHeader::kVersion;
+    header.nodes_number = n;
+    header.lightpath_bandwidth = lightpath_bandwidth;
+    header.edges_number = edges.size();
+    header.demands_number = demands.size();
+    header.edges_offset = sizeof(InstanceHeader);
+    header.demands_offset = header.edges_offset + edges.size() * sizeof(Edge);
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(edges.begin()), edges.size() * sizeof(Edge));
+    out.write(reinterpret_cast<const char *>(demands.begin()), demands.size() * sizeof(TrafficDemand));
+    if (!out) {
+        error = "cannot write " + path;
+        return false;
+    }
+    return true;
+}
+
+bool ReadTextInstance(const std::string &path, size_t &n, size_t &lightpath_bandwidth, std::vector<Edge> &edges,
+                      std::vector<TrafficDemand> &demands, std::string &error) {
+    std::ifstream in(path);
+    if (!in) {
+        error = "cannot open " + path;
+        return false;
+    }
+
+    // Comments are cut off line by line, the rest is read as a stream of numbers
+    std::stringstream numbers;
+    for (std::string line; std::getline(in, line);) {
+        numbers << line.substr(0, line.find('#')) << '\n';
+    }
+
+    size_t edges_number;
+    size_t demands_number;
+    if (!(numbers >> n >> edges_number >> demands_number >> lightpath_bandwidth)) {
+        error = path + " has no valid header line";
+        return false;
+    }
+    if (lightpath_bandwidth == 0) {
+        error = path + " has lightpaths of zero bandwidth";
+        return false;
+    }
+    edges.resize(edges_number);
+    for (Edge &edge: edges) {
+        if (!(numbers >> edge.source >> edge.destination) || edge.source >= n || edge.destination >= n) {
+            error = path + " has an invalid edge";
+            return false;
+        }
+    }
+    demands.resize(demands_number);
+    for (TrafficDemand &demand: demands) {
+        if (!(numbers >> demand.source >> demand.destination >> demand.bandwidth) || demand.source >= n ||
+            demand.destination >= n || demand.source == demand.destination ||
+            demand.bandwidth > lightpath_bandwidth) {
+            error = path + " has an invalid demand";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool ConvertTextInstance(const std::string &text_path, const std::string &binary_path, std::string &error) {
+    size_t n;
+    size_t lightpath_bandwidth;
+    std::vector<Edge> edges;
+    std::vector<TrafficDemand> demands;
+    return ReadTextInstance(text_path, n, lightpath_bandwidth, edges, demands, error) &&
+           InstanceFile::Write(binary_path, n, lightpath_bandwidth, edges, demands, error);
+}
@@ -0,0 +1,84 @@
+#include "headers/lower_bound.h"
+
+#include <algorithm>
+#include <numeric>
+
+LowerBound::LowerBound(size_t n, size_t lightpath_bandwidth, const std::vector<TrafficDemand> &traffic_demands)
+        : n_(n), lightpath_bandwidth_(lightpath_bandwidth), traffic_demands_(traffic_demands) {
+    Update();
+}
+
+void LowerBound::Update() {
+    bound_ = std::max({NodesBound(), TotalBandwidthBound(), ConnectivityBound()});
+}
+
+size_t LowerBound::Get() const {
+    return bound_;
+}
+
+double LowerBound::Gap(size_t lightpaths_number) const {
+    if (lightpaths_number == 0 || lightpaths_number <= bound_) {
+        return 0;
+    }
+    return static_cast<double>(lightpaths_number - bound_) / static_cast<double>(lightpaths_number);
+}
+
+size_t LowerBound::NodesBound() const {
+    // Lightpaths of no bandwidth give no bound on their number
+    if (lightpath_bandwidth_ == 0) {
+        return 0;
+    }
+
+    std::vector<size_t> loads(n_, 0);
+    for (const TrafficDemand &demand: traffic_demands_) {
+        loads[demand.source] += demand.bandwidth;
+        loads[demand.destination] += demand.bandwidth;
+    }
+
+    size_t max_lightpaths_number = 0;
+    size_t lightpaths_ends_number = 0;
+    for (size_t load: loads) {
+        size_t lightpaths_number = (load + lightpath_bandwidth_ - 1) / lightpath_bandwidth_;
+        max_lightpaths_number = std::max(max_lightpaths_number, lightpaths_number);
+        lightpaths_ends_number += lightpaths_number;
+    }
+
+    return std::max(max_lightpaths_number, (lightpaths_ends_number + 1) / 2);
+}
+
+size_t LowerBound::TotalBandwidthBound() const {
+    if (lightpath_bandwidth_ == 0) {
+        return 0;
+    }
+
+    size_t total_bandwidth = 0;
+    for (const TrafficDemand &demand: traffic_demands_) {
+        total_bandwidth += demand.bandwidth;
+    }
+
+    return (total_bandwidth + lightpath_bandwidth_ - 1) / lightpath_bandwidth_;
+}
+
+size_t LowerBound::ConnectivityBound() const {
+    std::vector<size_t> parents(n_);
+    std::iota(parents.begin(), parents.end(), 0);
+    auto find = [&parents](size_t v) {
+        while (parents[v] != v) {
+            parents[v] = parents[parents[v]];
+            v = parents[v];
+        }
+        return v;
+    };
+
+    size_t spanning_edges_number = 0;
+    for (const TrafficDemand &demand: traffic_demands_) {
+        size_t source = find(demand.source);
+        size_t destination = find(demand.destination);
+        if (source != destination) {
+            parents[source] = destination;
+            ++spanning_edges_number;
+        }
+    }
+
+    return spanning_edges_number;
+}
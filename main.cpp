@@ -1,9 +1,236 @@
+#include "headers/aggregation.h"
+#include "headers/algorithm.h"
+#include "headers/generator.h"
+#include "headers/instance.h"
+#include "headers/parallel_algorithm.h"
+#include "headers/solution_file.h"
 #include "headers/tester.h"
+#include "headers/trace.h"
+#include "headers/validator.h"
 
-int main() {
-    Tester::RingTests();
-    Tester::MeshTests();
-    Tester::RandomTests();
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
 
+// Parses a whole argument as a decimal number, without the exceptions of std::stoul
+static bool ParseNumber(const std::string &text, size_t &number) {
+    if (text.empty() || !std::isdigit(static_cast<unsigned char>(text[0]))) {
+        return false;
+    }
+    errno = 0;
+    char *end = nullptr;
+    unsigned long long value = std::strtoull(text.c_str(), &end, 10);
+    if (errno == ERANGE || *end != '\0') {
+        return false;
+    }
+    number = value;
+    return true;
+}
+
+static double MillisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static int Solve(const std::string &path, const RunConfig &config, size_t workers_number, bool aggregate,
+                 const std::string &warm_start_path, const std::string &stats_path, const std::string &trace_path) {
+    auto start = std::chrono::steady_clock::now();
+    InstanceFile instance;
+    std::string error;
+    if (!instance.Open(path, error)) {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+    size_t n = instance.GetNodesNumber();
+    size_t lightpath_bandwidth = instance.GetLightpathBandwidth();
+    std::vector<TrafficDemand> demands(instance.GetDemands().begin(), instance.GetDemands().end());
+    double load_time = MillisecondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    Graph network(n, instance.GetEdges());
+    double network_time = MillisecondsSince(start);
+
+    Solution previous_solution;
+    if (!warm_start_path.empty() && !LoadSolution(warm_start_path, n, previous_solution, error)) {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+
+    // With aggregation the solver, and so its checkpoints, only see the aggregates, and the solution is expanded
+    // back to the demands at the end
+    start = std::chrono::steady_clock::now();
+    DemandAggregation aggregation(aggregate ? demands : std::vector<TrafficDemand>(), lightpath_bandwidth);
+    const std::vector<TrafficDemand> &solved_demands = aggregate ? aggregation.GetAggregates() : demands;
+    if (!warm_start_path.empty() && !CheckSolution(previous_solution, n, solved_demands.size(), network, error)) {
+        std::cerr << warm_start_path << " does not fit " << path << ": " << error << std::endl;
+        return 1;
+    }
+    Solution solution;
+    size_t lower_bound;
+    SolverStats stats;
+    if (!warm_start_path.empty()) {
+        Algorithm algorithm(n, solved_demands.size(), lightpath_bandwidth, solved_demands, network, previous_solution);
+        solution = algorithm.Run(config);
+        lower_bound = algorithm.GetLowerBound().Get();
+        stats = algorithm.GetStats();
+    } else if (workers_number > 1) {
+        ParallelAlgorithm algorithm(n, solved_demands.size(), lightpath_bandwidth, solved_demands, network,
+                                    workers_number, workers_number);
+        solution = algorithm.Run(config);
+        lower_bound = algorithm.GetLowerBound().Get();
+        stats = algorithm.GetStats();
+    } else {
+        Algorithm algorithm(n, solved_demands.size(), lightpath_bandwidth, solved_demands, network);
+        solution = algorithm.Run(config);
+        lower_bound = algorithm.GetLowerBound().Get();
+        stats = algorithm.GetStats();
+    }
+    if (aggregate) {
+        solution = aggregation.Expand(solution);
+    }
+    double solve_time = MillisecondsSince(start);
+
+    Validator validator(n, demands.size(), lightpath_bandwidth, solution, network, demands);
+    ValidationFailure failure;
+    bool success = validator.Validate(failure);
+
+    std::cout << "Instance:\t\t" << path << " (" << n << " vertices, " << instance.GetEdges().size() << " edges, "
+              << demands.size() << " traffic demands)" << std::endl;
+    std::cout << "Lightpaths number:\t" << solution.lightpaths_number_ << "\tlower bound: " << lower_bound << std::endl;
+    std::cout << "Load time:\t\t" << load_time << " milliseconds" << std::endl;
+    std::cout << "Network time:\t\t" << network_time << " milliseconds" << std::endl;
+    std::cout << "Solve time:\t\t" << solve_time << " milliseconds" << std::endl;
+    std::cout << "Validation:\t\t" << (success ? "Correct :)" : "Incorrect :( " + failure.Describe()) << std::endl;
+
+    if (!trace_path.empty() && !Trace::WriteJson(trace_path, error)) {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+    if (!stats_path.empty()) {
+        std::ofstream out(stats_path);
+        stats.PrintJson(out);
+        if (!out) {
+            std::cerr << "cannot write " << stats_path << std::endl;
+            return 1;
+        }
+    }
+    return success ? 0 : 1;
+}
+
+static int Generate(const std::string &path, size_t n, size_t m, size_t seed) {
+    // Demands need two distinct endpoints
+    if (n < 2) {
+        std::cerr << "a network needs at least 2 nodes, got " << n << std::endl;
+        return 1;
+    }
+
+    Generator generator(seed);
+    DemandsConfig config;
+    config.model = DemandModel::kGravity;
+
+    std::string error;
+    if (!InstanceFile::Write(path, n, 16, generator.GenerateWaxman(n), generator.GenerateDemands(n, m, config),
+                             error)) {
+        std::cerr << error << std::endl;
+        return 1;
+    }
     return 0;
 }
+
+static void PrintUsage() {
+    std::cerr << "Usage:" << std::endl;
+    std::cerr << "  grasp4                                       run the test suites" << std::endl;
+    std::cerr << "  grasp4 solve INSTANCE [--time-limit=MS] [--workers=N] [--checkpoint=SOLUTION]" << std::endl;
+    std::cerr << "               [--checkpoint-interval=MS] [--warm-start=SOLUTION] [--stats=JSON]" << std::endl;
+    std::cerr << "               [--trace=JSON] [--aggregate] [--elite-pool=N]" << std::endl;
+    std::cerr << "                                              a warm start runs a single worker" << std::endl;
+    std::cerr << "  grasp4 convert TEXT_INSTANCE INSTANCE       convert the text format to the binary one"
+              << std::endl;
+    std::cerr << "  grasp4 generate INSTANCE N M [SEED]         write a Waxman network with gravity demands"
+              << std::endl;
+}
+
+int main(int argc, char **argv) {
+    if (argc == 1) {
+        Tester::RingTests();
+        Tester::MeshTests();
+        Tester::RandomTests();
+        Tester::ViolationTests();
+        Tester::ParallelTests();
+        Tester::OnlineTests();
+        Tester::ReplayTests();
+        Tester::CheckpointTests();
+        Tester::InstanceFileTests();
+        Tester::TopologyTests();
+        Tester::AggregationTests();
+        Tester::ElitePoolTests();
+
+        return 0;
+    }
+
+    std::string command = argv[1];
+    if (command == "solve" && argc >= 3) {
+        RunConfig config;
+        size_t workers_number = 1;
+        std::string warm_start_path;
+        std::string stats_path;
+        std::string trace_path;
+        bool aggregate = false;
+        for (int i = 3; i < argc; ++i) {
+            std::string argument = argv[i];
+            size_t number = 0;
+            bool is_valid = true;
+            if (argument.rfind("--time-limit=", 0) == 0) {
+                is_valid = ParseNumber(argument.substr(13), number);
+                if (number != 0) {
+                    config.time_budget = std::chrono::milliseconds(number);
+                }
+            } else if (argument.rfind("--workers=", 0) == 0) {
+                is_valid = ParseNumber(argument.substr(10), workers_number);
+            } else if (argument.rfind("--checkpoint=", 0) == 0) {
+                config.checkpoint_path = argument.substr(13);
+            } else if (argument.rfind("--checkpoint-interval=", 0) == 0) {
+                is_valid = ParseNumber(argument.substr(22), number);
+                config.checkpoint_interval = std::chrono::milliseconds(number);
+            } else if (argument.rfind("--warm-start=", 0) == 0) {
+                warm_start_path = argument.substr(13);
+            } else if (argument.rfind("--stats=", 0) == 0) {
+                stats_path = argument.substr(8);
+            } else if (argument.rfind("--trace=", 0) == 0) {
+                trace_path = argument.substr(8);
+            } else if (argument.rfind("--elite-pool=", 0) == 0) {
+                is_valid = ParseNumber(argument.substr(13), config.elite_pool_size);
+            } else if (argument == "--aggregate") {
+                aggregate = true;
+            } else {
+                is_valid = false;
+            }
+            if (!is_valid) {
+                PrintUsage();
+                return 1;
+            }
+        }
+        return Solve(argv[2], config, workers_number, aggregate, warm_start_path, stats_path, trace_path);
+    }
+    if (command == "convert" && argc == 4) {
+        std::string error;
+        if (!ConvertTextInstance(argv[2], argv[3], error)) {
+            std::cerr << error << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+    size_t n = 0;
+    size_t m = 0;
+    size_t seed = 1;
+    if (command == "generate" && (argc == 5 || argc == 6) && ParseNumber(argv[3], n) && ParseNumber(argv[4], m) &&
+        (argc == 5 || ParseNumber(argv[5], seed))) {
+        return Generate(argv[2], n, m, seed);
+    }
+
+    PrintUsage();
+    return 1;
+}
@@ -0,0 +1,112 @@
+#include "headers/parallel_algorithm.h"
+
+#include "headers/algorithm.h"
+#include "headers/solution_file.h"
+
+#include <algorithm>
+
+ParallelAlgorithm::ParallelAlgorithm(size_t n, size_t m, size_t lightpath_bandwidth,
+                                     const std::vector<TrafficDemand> &traffic_demands, const Graph &network,
+                                     size_t starts_number, size_t workers_number)
+        : n_(n), m_(m), lightpath_bandwidth_(lightpath_bandwidth), starts_number_(std::max<size_t>(1, starts_number)),
+          workers_number_(std::max<size_t>(1, std::min(workers_number, starts_number_))),
+          traffic_demands_(traffic_demands), network_(network), lower_bound_(n, lightpath_bandwidth, traffic_demands),
+          next_start_(0) {
+}
+
+Solution ParallelAlgorithm::Run(const RunConfig &config) {
+    auto start = std::chrono::steady_clock::now();
+    CancellationToken stop(config.cancellation_token);
+    config_ = &config;
+    stop_ = &stop;
+    deadline_ = std::chrono::steady_clock::time_point::max();
+    if (config.time_budget < deadline_ - start) {
+        deadline_ = start + config.time_budget;
+    }
+
+    next_start_ = 0;
+    best_solution_ = Solution();
+    best_solution_.lightpaths_number_ = SIZE_MAX;
+    last_checkpoint_ = start;
+    stats_ = SolverStats();
+    is_checkpointed_ = true;
+
+    std::vector<std::thread> workers;
+    workers.reserve(workers_number_ - 1);
+    for (size_t i = 1; i < workers_number_; ++i) {
+        workers.emplace_back(&ParallelAlgorithm::Work, this);
+    }
+    Work();
+    for (std::thread &worker: workers) {
+        worker.join();
+    }
+
+    if (!is_checkpointed_) {
+        Checkpoint();
+    }
+
+    return best_solution_;
+}
+
+const LowerBound &ParallelAlgorithm::GetLowerBound() const {
+    return lower_bound_;
+}
+
+const SolverStats &ParallelAlgorithm::GetStats() const {
+    return stats_;
+}
+
+void ParallelAlgorithm::Work() {
+    // Every start is an independent GRASP chain with its own virtual topology and demands order,
+    // only the physical network is shared between workers. The first start always runs, and completes its first
+    // construction whatever the budget, so that there is a valid solution to return
+    for (size_t start = next_start_++; start < starts_number_; start = next_start_++) {
+        auto now = std::chrono::steady_clock::now();
+        if (start != 0 && (stop_->IsCancelled() || now >= deadline_)) {
+            break;
+        }
+
+        RunConfig config = *config_;
+        config.time_budget = deadline_ - now;
+        config.cancellation_token = stop_;
+        config.on_incumbent = [this](const Solution &solution) {
+            Publish(solution);
+        };
+        // Only the best solution of all chains is checkpointed, by Publish
+        config.checkpoint_path.clear();
+
+        Algorithm algorithm(n_, m_, lightpath_bandwidth_, traffic_demands_, network_, start);
+        algorithm.Run(config);
+        if constexpr (kStatsEnabled) {
+            std::lock_guard<std::mutex> lock(best_solution_mutex_);
+            stats_.counters += algorithm.GetStats().counters;
+        }
+    }
+}
+
+void ParallelAlgorithm::Publish(const Solution &solution) {
+    std::lock_guard<std::mutex> lock(best_solution_mutex_);
+    if (solution.lightpaths_number_ < best_solution_.lightpaths_number_) {
+        best_solution_ = solution;
+        if (config_->on_incumbent) {
+            config_->on_incumbent(best_solution_);
+        }
+        if (best_solution_.lightpaths_number_ <= std::max(config_->target_lightpaths_number, lower_bound_.Get())) {
+            stop_->Cancel();
+        }
+
+        is_checkpointed_ = config_->checkpoint_path.empty();
+        if (!is_checkpointed_ &&
+            std::chrono::steady_clock::now() - last_checkpoint_ >= config_->checkpoint_interval) {
+            Checkpoint();
+        }
+    }
+}
+
+void ParallelAlgorithm::Checkpoint() {
+    std::string error;
+    if (SaveSolution(config_->checkpoint_path, best_solution_, error)) {
+        last_checkpoint_ = std::chrono::steady_clock::now();
+        is_checkpointed_ = true;
+    }
+}
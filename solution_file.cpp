@@ -0,0 +1,200 @@
+#include "headers/solution_file.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <utility>
+#include <vector>
+
+static_assert(sizeof(size_t) == sizeof(uint64_t), "The binary solution format needs 64-bit size_t");
+static_assert(sizeof(SolutionHeader) == 64, "SolutionHeader must match its binary layout");
+
+// After the header:
+//     nodes_number, unused_bandwidth      (lightpaths_size pairs)
+//     nodes of every lightpath            (nodes_pool_size words)
+//     number of lightpaths of every demand (demands_number words)
+//     lightpath ids of every demand       (assignments_number words)
+bool SaveSolution(const std::string &path, const Solution &solution, std::string &error) {
+    SolutionHeader header{};
+    std::memcpy(header.magic, SolutionHeader::kMagic, sizeof(header.magic));
+    header.version = SolutionHeader::kVersion;
+    header.mask_words = solution.mask_words_;
+    header.lightpaths_number = solution.lightpaths_number_;
+    header.lightpaths_size = solution.lightpaths_.size();
+    header.demands_number = solution.demand_lightpaths.size();
+
+    std::vector<uint64_t> words;
+    words.reserve(2 * solution.lightpaths_.size() + solution.nodes_pool_.size() + solution.demand_lightpaths.size());
+    for (size_t lp_id = 0; lp_id < solution.lightpaths_.size(); ++lp_id) {
+        words.push_back(solution.lightpaths_[lp_id].nodes_number);
+        words.push_back(solution.unused_bandwidth[lp_id]);
+    }
+    for (size_t lp_id = 0; lp_id < solution.lightpaths_.size(); ++lp_id) {
+        const size_t *nodes = solution.LightpathNodes(lp_id);
+        words.insert(words.end(), nodes, nodes + solution.lightpaths_[lp_id].nodes_number);
+        header.nodes_pool_size += solution.lightpaths_[lp_id].nodes_number;
+    }
+    for (const std::vector<size_t> &lightpaths_idxes: solution.demand_lightpaths) {
+        words.push_back(lightpaths_idxes.size());
+    }
+    for (const std::vector<size_t> &lightpaths_idxes: solution.demand_lightpaths) {
+        words.insert(words.end(), lightpaths_idxes.begin(), lightpaths_idxes.end());
+        header.assignments_number += lightpaths_idxes.size();
+    }
+
+    std::string temporary_path = path + ".tmp";
+    {
+        std::ofstream out(temporary_path, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char *>(words.data()), words.size() * sizeof(uint64_t));
+        out.flush();
+        if (!out) {
+            error = "cannot write " + temporary_path;
+            return false;
+        }
+    }
+    if (std::rename(temporary_path.c_str(), path.c_str()) != 0) {
+        error = "cannot rename " + temporary_path + " to " + path + ": " + std::strerror(errno);
+        std::remove(temporary_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool LoadSolution(const std::string &path, size_t n, Solution &solution, std::string &error) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        error = "cannot open " + path;
+        return false;
+    }
+
+    SolutionHeader header{};
+    if (!in.read(reinterpret_cast<char *>(&header), sizeof(header))) {
+        error = path + " is too small to be a solution file";
+        return false;
+    }
+    if (std::memcmp(header.magic, SolutionHeader::kMagic, sizeof(header.magic)) != 0) {
+        error = path + " is not a solution file";
+        return false;
+    }
+    if (header.version != SolutionHeader::kVersion) {
+        error = path + " has unsupported version " + std::to_string(header.version);
+        return false;
+    }
+    if (header.mask_words != NodeMaskWords(n)) {
+        error = path + " has node masks of " + std::to_string(header.mask_words) + " words, the instance needs " +
+                std::to_string(NodeMaskWords(n));
+        return false;
+    }
+
+    // The sizes are checked against the file size before anything is allocated
+    in.seekg(0, std::ios::end);
+    uint64_t words_number = (static_cast<uint64_t>(in.tellg()) - sizeof(header)) / sizeof(uint64_t);
+    in.seekg(sizeof(header));
+    if (header.lightpaths_size > words_number / 2) {
+        error = path + " is truncated";
+        return false;
+    }
+    uint64_t expected_words_number = 0;
+    for (uint64_t size: {2 * header.lightpaths_size, header.nodes_pool_size, header.demands_number,
+                         header.assignments_number}) {
+        if (size > words_number - expected_words_number) {
+            error = path + " is truncated";
+            return false;
+        }
+        expected_words_number += size;
+    }
+    std::vector<uint64_t> words(expected_words_number);
+    if (!in.read(reinterpret_cast<char *>(words.data()), words.size() * sizeof(uint64_t))) {
+        error = "cannot read " + path;
+        return false;
+    }
+
+    const uint64_t *lightpaths = words.data();
+    const uint64_t *nodes = lightpaths + 2 * header.lightpaths_size;
+    const uint64_t *paths_sizes = nodes + header.nodes_pool_size;
+    const uint64_t *assignments = paths_sizes + header.demands_number;
+
+    Solution loaded;
+    loaded.mask_words_ = header.mask_words;
+    uint64_t nodes_offset = 0;
+    std::vector<size_t> lightpath_nodes;
+    for (size_t lp_id = 0; lp_id < header.lightpaths_size; ++lp_id) {
+        uint64_t nodes_number = lightpaths[2 * lp_id];
+        if (nodes_number > header.nodes_pool_size - nodes_offset) {
+            error = path + " has a lightpath out of the nodes pool";
+            return false;
+        }
+        lightpath_nodes.assign(nodes + nodes_offset, nodes + nodes_offset + nodes_number);
+        nodes_offset += nodes_number;
+        for (size_t node: lightpath_nodes) {
+            if (node >= n) {
+                error = path + " has a lightpath with a node out of range";
+                return false;
+            }
+        }
+        loaded.AddLightpath(lightpaths[2 * lp_id + 1], lightpath_nodes);
+    }
+
+    // The use of every lightpath and its demands follow from the demands paths
+    loaded.demand_lightpaths.resize(header.demands_number);
+    uint64_t assignments_offset = 0;
+    for (size_t demand_id = 0; demand_id < header.demands_number; ++demand_id) {
+        uint64_t path_size = paths_sizes[demand_id];
+        if (path_size > header.assignments_number - assignments_offset) {
+            error = path + " has a demand path out of the assignments";
+            return false;
+        }
+        std::vector<size_t> &lightpaths_idxes = loaded.demand_lightpaths[demand_id];
+        lightpaths_idxes.assign(assignments + assignments_offset, assignments + assignments_offset + path_size);
+        assignments_offset += path_size;
+        for (size_t lp_id: lightpaths_idxes) {
+            if (lp_id >= header.lightpaths_size) {
+                error = path + " has a demand path with a lightpath out of range";
+                return false;
+            }
+            if (!loaded.use_of_lightpaths[lp_id]) {
+                loaded.use_of_lightpaths[lp_id] = true;
+                ++loaded.lightpaths_number_;
+            }
+            loaded.lightpath_demands[lp_id].push_back(demand_id);
+        }
+    }
+    if (loaded.lightpaths_number_ != header.lightpaths_number) {
+        error = path + " has an inconsistent number of used lightpaths";
+        return false;
+    }
+
+    solution = std::move(loaded);
+    return true;
+}
+
+bool CheckSolution(const Solution &solution, size_t n, size_t m, const Graph &network, std::string &error) {
+    if (solution.demand_lightpaths.size() != m) {
+        error = "the solution has " + std::to_string(solution.demand_lightpaths.size()) + " demands, the instance " +
+                std::to_string(m);
+        return false;
+    }
+    for (size_t lp_id = 0; lp_id < solution.lightpaths_.size(); ++lp_id) {
+        const size_t *nodes = solution.LightpathNodes(lp_id);
+        size_t nodes_number = solution.lightpaths_[lp_id].nodes_number;
+        if (nodes_number < 2) {
+            error = "lightpath " + std::to_string(lp_id) + " has less than two nodes";
+            return false;
+        }
+        for (size_t i = 0; i < nodes_number; ++i) {
+            if (nodes[i] >= n) {
+                error = "lightpath " + std::to_string(lp_id) + " has node " + std::to_string(nodes[i]) +
+                        ", the instance " + std::to_string(n) + " nodes";
+                return false;
+            }
+            if (i != 0 && !network.HasLink(nodes[i - 1], nodes[i])) {
+                error = "lightpath " + std::to_string(lp_id) + " goes from node " + std::to_string(nodes[i - 1]) +
+                        " to node " + std::to_string(nodes[i]) + ", which are not linked in the network";
+                return false;
+            }
+        }
+    }
+    return true;
+}
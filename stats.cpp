@@ -0,0 +1,38 @@
+#include "headers/stats.h"
+
+static const char *const kCountersNames[kStatsCountersNumber] = {
+        "searches",
+        "search_expansions",
+        "search_rejections",
+        "paths_found",
+        "new_lightpaths",
+        "grooming_attempts",
+        "grooming_successes",
+        "nogood_hits",
+};
+
+static const char *const kTimersNames[kStatsTimersNumber] = {
+        "run_ns",
+        "construct_ns",
+        "lightpath_min_ns",
+};
+
+void SolverStats::PrintJson(std::ostream &out) const {
+    out << "{\n";
+    out << "  \"enabled\": " << (kStatsEnabled ? "true" : "false") << ",\n";
+    out << "  \"counters\": {";
+    for (size_t i = 0; i < kStatsCountersNumber; ++i) {
+        out << (i == 0 ? "\n" : ",\n") << "    \"" << kCountersNames[i] << "\": " << counters.counters[i];
+    }
+    out << "\n  },\n";
+    out << "  \"timers\": {";
+    for (size_t i = 0; i < kStatsTimersNumber; ++i) {
+        out << (i == 0 ? "\n" : ",\n") << "    \"" << kTimersNames[i] << "\": " << counters.timers_ns[i];
+    }
+    out << "\n  },\n";
+    out << "  \"iterations_lightpaths\": [";
+    for (size_t i = 0; i < iterations_lightpaths.size(); ++i) {
+        out << (i == 0 ? "" : ", ") << iterations_lightpaths[i];
+    }
+    out << "]\n}" << std::endl;
+}
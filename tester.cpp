@@ -1,12 +1,20 @@
 #include "headers/tester.h"
 
+#include "headers/aggregation.h"
 #include "headers/generator.h"
 #include "headers/algorithm.h"
+#include "headers/instance.h"
+#include "headers/parallel_algorithm.h"
+#include "headers/solution_file.h"
 #include "headers/validator.h"
 
 #include <chrono>
+#include <cstdio>
+#include <fstream>
 #include <iostream>
+#include <map>
 #include <set>
+#include <thread>
 
 void Tester::RandomTests() {
     for (size_t n : {10, 15, 20}) {
@@ -91,6 +99,71 @@ void Tester::RandomValidationTest(size_t n, size_t m) {
 
     std::cout << "Results of validation for graph with " << n << " vertices and " << m << " traffic demands:" << std::endl;
     std::cout << "Validation:\t" << (success ? "Correct :)" : "Incorrect :(") << std::endl;
+    std::cout << "Lightpaths number:\t" << solution.lightpaths_number_ << "\tlower bound: "
+              << algorithm.GetLowerBound().Get() << "\tgap: " << algorithm.GetLowerBound().Gap(solution.lightpaths_number_)
+              << std::endl;
+    std::cout << std::string(100, '-') << std::endl;
+}
+
+void Tester::ViolationTests() {
+    for (size_t n : {10, 20}) {
+        ViolationTest(n, 50);
+    }
+}
+
+void Tester::ViolationTest(size_t n, size_t m) {
+    size_t lightpath_bandwidth;
+    std::vector<std::vector<size_t>> adj_matrix(n, std::vector<size_t>(n, 0));
+    std::vector<TrafficDemand> demands(m);
+
+    Generator generator;
+    generator.GenerateInput(n, m, lightpath_bandwidth, adj_matrix, demands);
+    Graph network(n, std::move(adj_matrix));
+
+    Algorithm algorithm(n, m, lightpath_bandwidth, demands, network);
+    Solution solution = algorithm.Run();
+
+    // Every case corrupts its own copy of the solution, and expects the violation and the ids it is reported at
+    auto check = [&](const Solution &corrupted, Violation violation, size_t demand_id, size_t lp_id) {
+        ValidationFailure failure;
+        Validator validator(n, m, lightpath_bandwidth, corrupted, network, demands);
+        return !validator.Validate(failure) && failure.violation == violation && failure.demand_id == demand_id &&
+               failure.lp_id == lp_id;
+    };
+    size_t lp_id = solution.demand_lightpaths[0].front();
+
+    Solution wrong_residual = solution;
+    ++wrong_residual.unused_bandwidth[lp_id];
+    bool residual_success = check(wrong_residual, Violation::kWrongResidual, SIZE_MAX, lp_id);
+
+    Solution wrong_use = solution;
+    wrong_use.use_of_lightpaths[lp_id] = false;
+    bool use_success = check(wrong_use, Violation::kWrongUse, SIZE_MAX, lp_id);
+
+    Solution wrong_path = solution;
+    wrong_path.demand_lightpaths[m - 1].push_back(solution.lightpaths_.size());
+    bool path_success = check(wrong_path, Violation::kUnknownLightpath, m - 1, solution.lightpaths_.size());
+
+    // An unused lightpath between two nodes the network does not link
+    bool link_success = true;
+    for (size_t u = 0; u < n; ++u) {
+        for (size_t v = u + 1; v < n; ++v) {
+            if (!network.HasLink(u, v)) {
+                Solution wrong_link = solution;
+                size_t link_lp_id = wrong_link.AddLightpath(lightpath_bandwidth, {u, v});
+                link_success = check(wrong_link, Violation::kMissingLink, SIZE_MAX, link_lp_id);
+                u = n;
+                break;
+            }
+        }
+    }
+
+    std::cout << "Results of violation test for graph with " << n << " vertices and " << m << " traffic demands:"
+              << std::endl;
+    std::cout << "Wrong residual:\t" << (residual_success ? "Correct :)" : "Incorrect :(") << std::endl;
+    std::cout << "Wrong use mark:\t" << (use_success ? "Correct :)" : "Incorrect :(") << std::endl;
+    std::cout << "Wrong path:\t" << (path_success ? "Correct :)" : "Incorrect :(") << std::endl;
+    std::cout << "Missing link:\t" << (link_success ? "Correct :)" : "Incorrect :(") << std::endl;
     std::cout << std::string(100, '-') << std::endl;
 }
 
@@ -650,3 +723,530 @@ void Tester::MeshSixTest() {
     std::cout << std::string(100, '-') << std::endl;
 }
 
+
+void Tester::ParallelTests() {
+    Generator generator;
+
+    size_t n = 10;
+    size_t m = 50;
+    size_t lightpath_bandwidth = 8;
+    std::vector<std::vector<size_t>> mesh_matrix {
+            {0, 1, 0, 0, 0, 0, 0, 1, 1, 0},
+            {1, 0, 1, 0, 0, 0, 0, 0, 1, 0},
+            {0, 1, 0, 1, 0, 0, 1, 0, 0, 0},
+            {0, 0, 1, 0, 1, 0, 0, 0, 0, 0},
+            {0, 0, 0, 1, 0, 1, 0, 0, 0, 1},
+            {0, 0, 0, 0, 1, 0, 1, 0, 0, 1},
+            {0, 0, 1, 0, 0, 1, 0, 1, 0, 0},
+            {1, 0, 0, 0, 0, 0, 1, 0, 1, 0},
+            {1, 1, 0, 0, 0, 0, 0, 1, 0, 1},
+            {0, 0, 0, 0, 1, 1, 0, 0, 1, 0},
+    };
+    std::vector<TrafficDemand> mesh_demands(m);
+    generator.GenerateDemands(n, m, lightpath_bandwidth, mesh_demands);
+    lightpath_bandwidth = 8;
+    for (TrafficDemand &demand: mesh_demands) {
+        demand.bandwidth = 1;
+    }
+    ParallelTest("Mesh3", n, m, lightpath_bandwidth, mesh_matrix, mesh_demands);
+
+    n = 15;
+    std::vector<std::vector<size_t>> random_matrix(n, std::vector<size_t>(n, 0));
+    std::vector<TrafficDemand> random_demands(m);
+    generator.GenerateInput(n, m, lightpath_bandwidth, random_matrix, random_demands);
+    ParallelTest("Random", n, m, lightpath_bandwidth, random_matrix, random_demands);
+}
+
+void Tester::ParallelTest(const std::string &name, size_t n, size_t m, size_t lightpath_bandwidth,
+                          const std::vector<std::vector<size_t>> &adj_matrix,
+                          const std::vector<TrafficDemand> &demands) {
+    Graph network(n, adj_matrix);
+
+    size_t starts_number = std::max<size_t>(8, std::thread::hardware_concurrency());
+
+    std::cout << "Results of parallel " << name << " test (" << n << " vertices, " << m << " traffic demands, "
+              << starts_number << " starts):" << std::endl;
+
+    size_t single_ex_time = 0;
+    for (size_t workers_number = 1; workers_number <= starts_number; workers_number *= 2) {
+        ParallelAlgorithm algorithm(n, m, lightpath_bandwidth, demands, network, starts_number, workers_number);
+
+        auto start = std::chrono::high_resolution_clock::now();
+        Solution solution = algorithm.Run();
+        auto stop = std::chrono::high_resolution_clock::now();
+
+        size_t ex_time = std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count();
+        if (workers_number == 1) {
+            single_ex_time = ex_time;
+        }
+
+        Validator validator(n, m, lightpath_bandwidth, solution, network, demands);
+
+        std::cout << "Workers: " << workers_number << "\tlightpaths: " << solution.lightpaths_number_
+                  << "\tgap: " << algorithm.GetLowerBound().Gap(solution.lightpaths_number_)
+                  << "\ttime: " << ex_time << " microseconds\tspeedup: "
+                  << static_cast<double>(single_ex_time) / static_cast<double>(std::max<size_t>(1, ex_time))
+                  << "\tvalidation: " << (validator.Validate() ? "Correct :)" : "Incorrect :(") << std::endl;
+    }
+
+    // A budget that expires before any start completes still returns the first construction
+    {
+        ParallelAlgorithm algorithm(n, m, lightpath_bandwidth, demands, network, starts_number, starts_number);
+        RunConfig config;
+        config.time_budget = std::chrono::nanoseconds(0);
+        Solution solution = algorithm.Run(config);
+        Validator validator(n, m, lightpath_bandwidth, solution, network, demands);
+
+        std::cout << "Expired budget:\tlightpaths: " << solution.lightpaths_number_ << "\tvalidation: "
+                  << (validator.Validate() ? "Correct :)" : "Incorrect :(") << std::endl;
+    }
+
+    for (size_t workers_number = 1; workers_number <= starts_number; workers_number *= 2) {
+        Algorithm algorithm(n, m, lightpath_bandwidth, demands, network);
+        RunConfig config;
+        config.speculative_workers = workers_number;
+
+        auto start = std::chrono::high_resolution_clock::now();
+        Solution solution = algorithm.Run(config);
+        auto stop = std::chrono::high_resolution_clock::now();
+
+        size_t ex_time = std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count();
+        Validator validator(n, m, lightpath_bandwidth, solution, network, demands);
+
+        std::cout << "Speculative workers: " << workers_number << "\tlightpaths: " << solution.lightpaths_number_
+                  << "\ttime: " << ex_time << " microseconds\tvalidation: "
+                  << (validator.Validate() ? "Correct :)" : "Incorrect :(") << std::endl;
+    }
+    std::cout << std::string(100, '-') << std::endl;
+}
+
+void Tester::OnlineTests() {
+    for (size_t n : {10, 15, 20}) {
+        OnlineTest(n, 100);
+    }
+}
+
+void Tester::OnlineTest(size_t n, size_t m) {
+    size_t lightpath_bandwidth;
+    std::vector<std::vector<size_t>> adj_matrix(n, std::vector<size_t>(n, 0));
+    std::vector<TrafficDemand> demands(m);
+
+    Generator generator;
+    generator.GenerateInput(n, m, lightpath_bandwidth, adj_matrix, demands);
+    Graph network(n, std::move(adj_matrix));
+
+    Algorithm offline_algorithm(n, m, lightpath_bandwidth, demands, network);
+    auto start = std::chrono::high_resolution_clock::now();
+    size_t offline_lightpaths_number = offline_algorithm.Run().lightpaths_number_;
+    auto stop = std::chrono::high_resolution_clock::now();
+    size_t offline_ex_time = std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count();
+
+    // The demands of an offline solver are the caller's, so it refuses to change them
+    bool offline_guard_success = offline_algorithm.AddDemand(demands[0]) == SIZE_MAX &&
+                                 !offline_algorithm.RemoveDemand(0) &&
+                                 offline_algorithm.GetDemands().size() == m;
+
+    Algorithm algorithm(n, lightpath_bandwidth, network);
+    start = std::chrono::high_resolution_clock::now();
+    for (const TrafficDemand &demand: demands) {
+        algorithm.AddDemand(demand);
+    }
+    stop = std::chrono::high_resolution_clock::now();
+    size_t add_ex_time = std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count();
+    Validator add_validator(n, m, lightpath_bandwidth, algorithm.GetSolution(), network, algorithm.GetDemands());
+    bool add_success = add_validator.Validate();
+    size_t add_lightpaths_number = algorithm.GetSolution().lightpaths_number_;
+
+    // Removing every third demand from the end also moves the last demands into the freed ids
+    size_t removals_number = 0;
+    start = std::chrono::high_resolution_clock::now();
+    for (size_t demand_id = m - 1; demand_id < m; demand_id -= 3) {
+        algorithm.RemoveDemand(demand_id);
+        ++removals_number;
+    }
+    stop = std::chrono::high_resolution_clock::now();
+    size_t remove_ex_time = std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count();
+    Validator remove_validator(n, algorithm.GetDemands().size(), lightpath_bandwidth, algorithm.GetSolution(), network,
+                               algorithm.GetDemands());
+    bool remove_success = remove_validator.Validate();
+
+    std::cout << "Results of online test for graph with " << n << " vertices and " << m << " traffic demands:"
+              << std::endl;
+    std::cout << "Full run:\t\tlightpaths: " << offline_lightpaths_number << "\ttime: " << offline_ex_time
+              << " microseconds\toffline changes refused: " << (offline_guard_success ? "Correct :)" : "Incorrect :(")
+              << std::endl;
+    std::cout << "Online adds:\t\tlightpaths: " << add_lightpaths_number << "\tmean time: " << add_ex_time / m
+              << " microseconds\tvalidation: " << (add_success ? "Correct :)" : "Incorrect :(") << std::endl;
+    std::cout << "Online removes:\t\tlightpaths: " << algorithm.GetSolution().lightpaths_number_ << "\tmean time: "
+              << remove_ex_time / removals_number << " microseconds\tvalidation: "
+              << (remove_success ? "Correct :)" : "Incorrect :(") << std::endl;
+    std::cout << std::string(100, '-') << std::endl;
+}
+
+void Tester::ReplayTests() {
+    for (size_t n : {15, 20}) {
+        ReplayTest(n, 100, 10, 0.1);
+    }
+}
+
+void Tester::ReplayTest(size_t n, size_t m, size_t epochs_number, double drift) {
+    size_t lightpath_bandwidth;
+    std::vector<std::vector<size_t>> adj_matrix(n, std::vector<size_t>(n, 0));
+    std::vector<TrafficDemand> demands(m);
+
+    Generator generator;
+    generator.GenerateInput(n, m, lightpath_bandwidth, adj_matrix, demands);
+    Graph network(n, std::move(adj_matrix));
+
+    std::cout << "Results of replay test for graph with " << n << " vertices, " << m << " traffic demands, "
+              << epochs_number << " epochs and drift " << drift << ":" << std::endl;
+
+    Solution cold_solution;
+    Solution warm_solution;
+    size_t cold_ex_time_sum = 0, warm_ex_time_sum = 0, cold_churn_sum = 0, warm_churn_sum = 0;
+    for (size_t epoch = 0; epoch < epochs_number; ++epoch) {
+        if (epoch != 0) {
+            generator.DriftDemands(n, drift, demands);
+        }
+
+        Algorithm cold_algorithm(n, m, lightpath_bandwidth, demands, network);
+        auto start = std::chrono::high_resolution_clock::now();
+        Solution cold_next_solution = cold_algorithm.Run();
+        auto stop = std::chrono::high_resolution_clock::now();
+        size_t cold_ex_time = std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count();
+
+        // The first epoch has nothing to warm start from
+        Algorithm warm_algorithm(n, m, lightpath_bandwidth, demands, network, warm_solution);
+        start = std::chrono::high_resolution_clock::now();
+        Solution warm_next_solution = warm_algorithm.Run();
+        stop = std::chrono::high_resolution_clock::now();
+        size_t warm_ex_time = std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count();
+
+        Validator validator(n, m, lightpath_bandwidth, warm_next_solution, network, demands);
+        bool success = validator.Validate();
+
+        size_t cold_churn = LightpathsChurn(cold_solution, cold_next_solution);
+        size_t warm_churn = LightpathsChurn(warm_solution, warm_next_solution);
+        if (epoch != 0) {
+            cold_ex_time_sum += cold_ex_time;
+            warm_ex_time_sum += warm_ex_time;
+            cold_churn_sum += cold_churn;
+            warm_churn_sum += warm_churn;
+        }
+
+        std::cout << "Epoch " << epoch << "\tcold: " << cold_next_solution.lightpaths_number_ << " lightpaths, "
+                  << cold_churn << " churn, " << cold_ex_time << " microseconds\twarm: "
+                  << warm_next_solution.lightpaths_number_ << " lightpaths, " << warm_churn << " churn, "
+                  << warm_ex_time << " microseconds\tvalidation: " << (success ? "Correct :)" : "Incorrect :(")
+                  << std::endl;
+
+        cold_solution = std::move(cold_next_solution);
+        warm_solution = std::move(warm_next_solution);
+    }
+
+    if (epochs_number > 1) {
+        std::cout << "Mean after the first epoch\tcold: " << cold_churn_sum / (epochs_number - 1) << " churn, "
+                  << cold_ex_time_sum / (epochs_number - 1) << " microseconds\twarm: "
+                  << warm_churn_sum / (epochs_number - 1) << " churn, " << warm_ex_time_sum / (epochs_number - 1)
+                  << " microseconds" << std::endl;
+    }
+    std::cout << std::string(100, '-') << std::endl;
+}
+
+void Tester::CheckpointTests() {
+    for (size_t n : {10, 20}) {
+        CheckpointTest(n, 100);
+    }
+}
+
+void Tester::CheckpointTest(size_t n, size_t m) {
+    size_t lightpath_bandwidth;
+    std::vector<std::vector<size_t>> adj_matrix(n, std::vector<size_t>(n, 0));
+    std::vector<TrafficDemand> demands(m);
+
+    Generator generator;
+    generator.GenerateInput(n, m, lightpath_bandwidth, adj_matrix, demands);
+    Graph network(n, std::move(adj_matrix));
+
+    Algorithm algorithm(n, m, lightpath_bandwidth, demands, network);
+    Solution solution = algorithm.Run();
+
+    std::string path = "grasp4_checkpoint_test.bin";
+    std::string error;
+    Solution loaded_solution;
+    bool load_success = SaveSolution(path, solution, error) && LoadSolution(path, n, loaded_solution, error);
+    std::remove(path.c_str());
+    load_success = load_success && CheckSolution(loaded_solution, n, m, network, error) &&
+                   loaded_solution.lightpaths_number_ == solution.lightpaths_number_;
+    Validator validator(n, m, lightpath_bandwidth, loaded_solution, network, demands);
+    load_success = load_success && validator.Validate();
+
+    // A checkpoint of another instance is refused: one with more demands, or one over a network without its links
+    Graph unlinked_network(n, std::vector<std::vector<size_t>>(n, std::vector<size_t>(n, 0)));
+    bool refuse_success = !CheckSolution(loaded_solution, n, m + 1, network, error) &&
+                          !CheckSolution(loaded_solution, n, m, unlinked_network, error) &&
+                          !CheckSolution(loaded_solution, n / 2, m, network, error);
+
+    Algorithm warm_algorithm(n, m, lightpath_bandwidth, demands, network, loaded_solution);
+    Solution warm_solution = warm_algorithm.Run();
+    Validator warm_validator(n, m, lightpath_bandwidth, warm_solution, network, demands);
+    bool warm_success = warm_validator.Validate() && warm_solution.lightpaths_number_ <= solution.lightpaths_number_;
+
+    std::cout << "Results of checkpoint test for graph with " << n << " vertices and " << m << " traffic demands:"
+              << std::endl;
+    std::cout << "Saved:\t\tlightpaths: " << solution.lightpaths_number_ << "\tload: "
+              << (load_success ? "Correct :)" : "Incorrect :( " + error) << "\tother instances refused: "
+              << (refuse_success ? "Correct :)" : "Incorrect :(") << std::endl;
+    std::cout << "Warm start:\tlightpaths: " << warm_solution.lightpaths_number_ << "\tvalidation: "
+              << (warm_success ? "Correct :)" : "Incorrect :(") << std::endl;
+    std::cout << std::string(100, '-') << std::endl;
+}
+
+void Tester::InstanceFileTests() {
+    for (size_t n : {10, 1000}) {
+        InstanceFileTest(n, 10 * n);
+    }
+}
+
+void Tester::InstanceFileTest(size_t n, size_t m) {
+    Generator generator(n);
+    size_t lightpath_bandwidth = 16;
+    std::vector<Edge> edges = generator.GenerateWaxman(n);
+    std::vector<TrafficDemand> demands = generator.GenerateDemands(n, m, DemandsConfig());
+
+    // An open instance file has to give back exactly what was written or converted
+    auto matches = [&](const InstanceFile &instance) {
+        Span<Edge> read_edges = instance.GetEdges();
+        Span<TrafficDemand> read_demands = instance.GetDemands();
+        if (instance.GetNodesNumber() != n || instance.GetLightpathBandwidth() != lightpath_bandwidth ||
+            read_edges.size() != edges.size() || read_demands.size() != demands.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < edges.size(); ++i) {
+            if (read_edges[i].source != edges[i].source || read_edges[i].destination != edges[i].destination) {
+                return false;
+            }
+        }
+        for (size_t i = 0; i < demands.size(); ++i) {
+            if (read_demands[i].source != demands[i].source ||
+                read_demands[i].destination != demands[i].destination ||
+                read_demands[i].bandwidth != demands[i].bandwidth) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    std::string path = "grasp4_instance_test.bin";
+    std::string text_path = "grasp4_instance_test.txt";
+    std::string error;
+    InstanceFile instance;
+    bool binary_success = InstanceFile::Write(path, n, lightpath_bandwidth, edges, demands, error) &&
+                          instance.Open(path, error) && matches(instance);
+    instance.Close();
+
+    std::ofstream text(text_path);
+    text << "# round trip test\n" << n << " " << edges.size() << " " << demands.size() << " " << lightpath_bandwidth
+         << "\n";
+    for (const Edge &edge: edges) {
+        text << edge.source << " " << edge.destination << "\n";
+    }
+    for (const TrafficDemand &demand: demands) {
+        text << demand.source << " " << demand.destination << " " << demand.bandwidth << "\n";
+    }
+    text.close();
+    bool text_success = ConvertTextInstance(text_path, path, error) && instance.Open(path, error) &&
+                        matches(instance);
+    instance.Close();
+
+    // Without the edges of its last node, the demands to that node cannot be routed, so the file is refused
+    std::vector<Edge> cut_edges;
+    for (const Edge &edge: edges) {
+        if (edge.source != n - 1 && edge.destination != n - 1) {
+            cut_edges.push_back(edge);
+        }
+    }
+    std::vector<TrafficDemand> cut_demands = {TrafficDemand(0, n - 1, 1)};
+    std::string cut_error;
+    bool disconnected_success = InstanceFile::Write(path, n, lightpath_bandwidth, cut_edges, cut_demands, error) &&
+                                !instance.Open(path, cut_error) && !cut_error.empty();
+
+    // Lightpaths without bandwidth cannot carry anything, so such a file is refused too
+    std::string zero_error;
+    bool zero_bandwidth_success = InstanceFile::Write(path, n, 0, edges, {}, error) &&
+                                  !instance.Open(path, zero_error) && !zero_error.empty();
+    std::remove(path.c_str());
+    std::remove(text_path.c_str());
+
+    std::cout << "Results of instance file test for graph with " << n << " vertices and " << m << " traffic demands:"
+              << std::endl;
+    std::cout << "Binary round trip:\t" << (binary_success ? "Correct :)" : "Incorrect :( " + error) << std::endl;
+    std::cout << "Text conversion:\t" << (text_success ? "Correct :)" : "Incorrect :( " + error) << std::endl;
+    std::cout << "Disconnected demand refused:\t" << (disconnected_success ? "Correct :)" : "Incorrect :(")
+              << std::endl;
+    std::cout << "Zero bandwidth refused:\t" << (zero_bandwidth_success ? "Correct :)" : "Incorrect :(")
+              << std::endl;
+    std::cout << std::string(100, '-') << std::endl;
+}
+
+size_t Tester::LightpathsChurn(const Solution &previous_solution, const Solution &solution) {
+    std::map<std::vector<size_t>, long long> lightpaths_balance;
+    auto count_lightpaths = [&lightpaths_balance](const Solution &solution, long long sign) {
+        for (size_t lp_id = 0; lp_id < solution.lightpaths_.size(); ++lp_id) {
+            if (solution.use_of_lightpaths[lp_id]) {
+                const size_t *nodes = solution.LightpathNodes(lp_id);
+                lightpaths_balance[{nodes, nodes + solution.lightpaths_[lp_id].nodes_number}] += sign;
+            }
+        }
+    };
+    count_lightpaths(previous_solution, -1);
+    count_lightpaths(solution, 1);
+
+    size_t churn = 0;
+    for (const auto &[nodes, balance]: lightpaths_balance) {
+        churn += std::abs(balance);
+    }
+    return churn;
+}
+
+void Tester::TopologyTests() {
+    Generator generator(1);
+    size_t m = 100;
+
+    DemandsConfig uniform;
+    DemandsConfig gravity;
+    gravity.model = DemandModel::kGravity;
+    DemandsConfig hotspot;
+    hotspot.model = DemandModel::kHotspot;
+
+    TopologyTest("Ring", 20, m, Generator::GenerateRing(20), generator.GenerateDemands(20, m, uniform));
+    TopologyTest("Grid", 25, m, Generator::GenerateGrid(5, 5), generator.GenerateDemands(25, m, uniform));
+    TopologyTest("Paper mesh 3", 10, m, Generator::GeneratePaperMesh(3), generator.GenerateDemands(10, m, uniform));
+    TopologyTest("Waxman", 30, m, generator.GenerateWaxman(30), generator.GenerateDemands(30, m, gravity));
+    TopologyTest("Barabasi-Albert", 30, m, generator.GenerateBarabasiAlbert(30),
+                 generator.GenerateDemands(30, m, hotspot));
+}
+
+void Tester::TopologyTest(const std::string &name, size_t n, size_t m, const std::vector<Edge> &edges,
+                          const std::vector<TrafficDemand> &demands) {
+    size_t lightpath_bandwidth = 16;
+    Graph network(n, edges);
+
+    Algorithm algorithm(n, m, lightpath_bandwidth, demands, network);
+    auto start = std::chrono::high_resolution_clock::now();
+    Solution solution = algorithm.Run();
+    auto stop = std::chrono::high_resolution_clock::now();
+    size_t ex_time = std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count();
+
+    Validator validator(n, m, lightpath_bandwidth, solution, network, demands);
+
+    std::cout << "Results of " << name << " topology test (" << n << " vertices, " << edges.size() << " edges, " << m
+              << " traffic demands):" << std::endl;
+    std::cout << "Lightpaths number:\t" << solution.lightpaths_number_ << "\tgap: "
+              << algorithm.GetLowerBound().Gap(solution.lightpaths_number_) << "\ttime: " << ex_time
+              << " microseconds\tvalidation: " << (validator.Validate() ? "Correct :)" : "Incorrect :(") << std::endl;
+    std::cout << std::string(100, '-') << std::endl;
+}
+
+void Tester::AggregationTests() {
+    for (auto [n, m] : {std::pair<size_t, size_t>{10, 100}, std::pair<size_t, size_t>{12, 200},
+                        std::pair<size_t, size_t>{15, 300}}) {
+        AggregationTest(n, m);
+    }
+}
+
+void Tester::AggregationTest(size_t n, size_t m) {
+    size_t lightpath_bandwidth = 16;
+    Generator generator(1);
+    DemandsConfig gravity;
+    gravity.model = DemandModel::kGravity;
+    Graph network(n, generator.GenerateWaxman(n));
+    std::vector<TrafficDemand> demands = generator.GenerateDemands(n, m, gravity);
+
+    Algorithm algorithm(n, m, lightpath_bandwidth, demands, network);
+    auto start = std::chrono::high_resolution_clock::now();
+    Solution solution = algorithm.Run();
+    auto stop = std::chrono::high_resolution_clock::now();
+    size_t ex_time = std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count();
+
+    // The aggregation is part of the measured time, as it is of every solve that uses it
+    start = std::chrono::high_resolution_clock::now();
+    DemandAggregation aggregation(demands, lightpath_bandwidth);
+    const std::vector<TrafficDemand> &aggregates = aggregation.GetAggregates();
+    Algorithm aggregated_algorithm(n, aggregates.size(), lightpath_bandwidth, aggregates, network);
+    Solution aggregated_solution = aggregation.Expand(aggregated_algorithm.Run());
+    stop = std::chrono::high_resolution_clock::now();
+    size_t aggregated_ex_time = std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count();
+
+    Validator validator(n, m, lightpath_bandwidth, solution, network, demands);
+    Validator aggregated_validator(n, m, lightpath_bandwidth, aggregated_solution, network, demands);
+
+    std::cout << "Results of aggregation test for graph with " << n << " vertices and " << m
+              << " gravity traffic demands (" << aggregates.size() << " aggregates):" << std::endl;
+    std::cout << "Per demand:\tlightpaths number: " << solution.lightpaths_number_ << "\ttime: " << ex_time
+              << " microseconds\tvalidation: " << (validator.Validate() ? "Correct :)" : "Incorrect :(") << std::endl;
+    std::cout << "Aggregated:\tlightpaths number: " << aggregated_solution.lightpaths_number_ << "\ttime: "
+              << aggregated_ex_time << " microseconds\tvalidation: "
+              << (aggregated_validator.Validate() ? "Correct :)" : "Incorrect :(") << std::endl;
+    std::cout << std::string(100, '-') << std::endl;
+}
+
+void Tester::ElitePoolTests() {
+    for (size_t instance = 1; instance <= 6; ++instance) {
+        ElitePoolTest(instance, 100);
+    }
+}
+
+void Tester::ElitePoolTest(size_t instance, size_t m) {
+    size_t n = 10;
+    size_t lightpath_bandwidth = 16;
+    size_t starts_number = 10;
+    size_t elite_pool_size = 8;
+    Generator generator(instance);
+    Graph network(n, Generator::GeneratePaperMesh(instance));
+    std::vector<TrafficDemand> demands = generator.GenerateDemands(n, m, DemandsConfig());
+
+    // The target is the best lightpaths number that either variant reaches in a long run from the given order
+    RunConfig config;
+    config.max_iterations = 50;
+    config.max_no_changes_iterations = SIZE_MAX;
+    size_t target = SIZE_MAX;
+    for (size_t pool_size : {size_t(0), elite_pool_size}) {
+        config.elite_pool_size = pool_size;
+        Algorithm algorithm(n, m, lightpath_bandwidth, demands, network);
+        target = std::min(target, algorithm.Run(config).lightpaths_number_);
+    }
+    config.target_lightpaths_number = target;
+
+    std::cout << "Results of elite pool test on paper mesh " << instance << " (" << n << " vertices, " << m
+              << " traffic demands, target " << target << " lightpaths, " << starts_number << " starts of at most "
+              << config.max_iterations << " iterations):" << std::endl;
+    // A run stops at the target, so a start is charged the iterations and time it ran whether it reached the target
+    // or not, and the means are taken over all starts
+    for (size_t pool_size : {size_t(0), elite_pool_size}) {
+        config.elite_pool_size = pool_size;
+        size_t reached_number = 0;
+        size_t iterations_sum = 0;
+        size_t ex_time_sum = 0;
+        bool success = true;
+        for (size_t seed = 1; seed <= starts_number; ++seed) {
+            Algorithm algorithm(n, m, lightpath_bandwidth, demands, network, seed);
+            auto start = std::chrono::high_resolution_clock::now();
+            Solution solution = algorithm.Run(config);
+            auto stop = std::chrono::high_resolution_clock::now();
+
+            reached_number += solution.lightpaths_number_ <= target;
+            iterations_sum += algorithm.GetStats().iterations_lightpaths.size();
+            ex_time_sum += std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count();
+            Validator validator(n, m, lightpath_bandwidth, solution, network, demands);
+            success = success && validator.Validate();
+        }
+
+        std::cout << "Elite pool: " << pool_size << "\treached target: " << reached_number << "/" << starts_number
+                  << "\tmean iterations to target: "
+                  << static_cast<double>(iterations_sum) / static_cast<double>(starts_number)
+                  << "\tmean time to target: " << ex_time_sum / starts_number << " microseconds"
+                  << "\tvalidation: " << (success ? "Correct :)" : "Incorrect :(") << std::endl;
+    }
+    std::cout << std::string(100, '-') << std::endl;
+}
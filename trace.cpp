@@ -0,0 +1,112 @@
+#include "headers/trace.h"
+
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+struct TraceBuffer {
+    std::unique_ptr<TraceEvent[]> events = std::make_unique<TraceEvent[]>(Trace::kCapacity);
+
+    // Threads that reuse a buffer never run at the same time, so they share its timeline track
+    uint64_t thread_id = 0;
+
+    // Number of events ever recorded, the last kCapacity of them are in events[size % kCapacity]
+    std::atomic<size_t> size = 0;
+};
+
+struct TraceRegistry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<TraceBuffer>> buffers;
+    std::vector<TraceBuffer *> free_buffers;
+};
+
+static TraceRegistry &Registry() {
+    static TraceRegistry registry;
+    return registry;
+}
+
+// Takes a buffer when its thread records the first event, and gives it back with its events when the thread ends
+class ThreadTrace {
+public:
+    ThreadTrace() {
+        TraceRegistry &registry = Registry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        if (registry.free_buffers.empty()) {
+            registry.buffers.push_back(std::make_unique<TraceBuffer>());
+            buffer_ = registry.buffers.back().get();
+            buffer_->thread_id = registry.buffers.size();
+        } else {
+            buffer_ = registry.free_buffers.back();
+            registry.free_buffers.pop_back();
+        }
+    }
+
+    ~ThreadTrace() {
+        TraceRegistry &registry = Registry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        registry.free_buffers.push_back(buffer_);
+    }
+
+    ThreadTrace(const ThreadTrace &) = delete;
+    ThreadTrace &operator=(const ThreadTrace &) = delete;
+
+    TraceBuffer *buffer_;
+};
+
+static const std::chrono::steady_clock::time_point kTraceEpoch = std::chrono::steady_clock::now();
+
+uint64_t Trace::Now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - kTraceEpoch)
+            .count();
+}
+
+void Trace::Record(const char *name, uint64_t start_ns, uint64_t duration_ns, uint64_t arg) {
+    thread_local ThreadTrace thread_trace;
+    TraceBuffer &buffer = *thread_trace.buffer_;
+    size_t size = buffer.size.load(std::memory_order_relaxed);
+    buffer.events[size % kCapacity] = {name, start_ns, duration_ns, arg, buffer.thread_id};
+    buffer.size.store(size + 1, std::memory_order_release);
+}
+
+void Trace::Clear() {
+    TraceRegistry &registry = Registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (const std::unique_ptr<TraceBuffer> &buffer: registry.buffers) {
+        buffer->size.store(0, std::memory_order_relaxed);
+    }
+}
+
+bool Trace::WriteJson(const std::string &path, std::string &error) {
+    std::ofstream out(path);
+    // Trace events are in microseconds, the default 6 significant digits would round off long runs
+    out << std::fixed << std::setprecision(3);
+    out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+
+    TraceRegistry &registry = Registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    bool is_first = true;
+    for (const std::unique_ptr<TraceBuffer> &buffer: registry.buffers) {
+        size_t size = buffer->size.load(std::memory_order_acquire);
+        for (size_t i = size > kCapacity ? size - kCapacity : 0; i < size; ++i) {
+            const TraceEvent &event = buffer->events[i % kCapacity];
+            out << (is_first ? "\n" : ",\n") << "{\"name\": \"" << event.name << "\", \"ph\": \"X\", \"pid\": 1"
+                << ", \"tid\": " << event.thread_id << ", \"ts\": " << event.start_ns / 1000.0
+                << ", \"dur\": " << event.duration_ns / 1000.0;
+            if (event.arg != kNoArg) {
+                out << ", \"args\": {\"arg\": " << event.arg << "}";
+            }
+            out << "}";
+            is_first = false;
+        }
+    }
+    out << "\n]}" << std::endl;
+
+    if (!out) {
+        error = "cannot write " + path;
+        return false;
+    }
+    return true;
+}
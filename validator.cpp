@@ -1,56 +1,194 @@
 #include "headers/validator.h"
+#include "headers/path_policy.h"
 
-#include <functional>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+
+std::string ValidationFailure::Describe() const {
+    std::string demand = "demand " + std::to_string(demand_id);
+    std::string lightpath = "lightpath " + std::to_string(lp_id);
+    switch (violation) {
+        case Violation::kNone:
+            return "valid";
+        case Violation::kMissingPath:
+            return demand + " is not routed";
+        case Violation::kUnknownLightpath:
+            return demand + " is routed over " + lightpath + ", which does not exist";
+        case Violation::kDisconnectedPath:
+            return demand + " is routed over a path that does not lead from its source to its destination at " +
+                   lightpath;
+        case Violation::kNotSimplePath:
+            return demand + " is routed over a path that visits a node twice at " + lightpath;
+        case Violation::kOverloadedLightpath:
+            return lightpath + " carries more than its bandwidth";
+        case Violation::kWrongResidual:
+            return lightpath + " has a residual bandwidth that does not match its demands";
+        case Violation::kWrongUse:
+            return lightpath + " is marked used while it has no demands, or the other way round";
+        case Violation::kWrongLightpathsNumber:
+            return "the lightpaths number does not match the used lightpaths";
+        case Violation::kMissingLink:
+            return lightpath + " goes between two nodes that are not linked in the network";
+    }
+    return "unknown violation";
+}
 
 Validator::Validator(size_t n, size_t m, size_t lightpath_bandwidth, const Solution &solution, const Graph &network,
-                     const std::vector<TrafficDemand> &demands)
+                     const std::vector<TrafficDemand> &demands, size_t workers_number)
         : n_(n), m_(m), l_(solution.lightpaths_.size()), lightpath_bandwidth_(lightpath_bandwidth),
+          workers_number_(std::max<size_t>(1, std::min(workers_number, (m + kChunkSize - 1) / kChunkSize))),
           solution_(solution), demands_(demands), network_(network) {
 }
 
 bool Validator::Validate() const {
-    auto is_not_overused = [this](const std::vector<size_t> &path, size_t lightpath_bandwidth) {
-        return std::all_of(path.begin(), path.end(),
-                           [this, lightpath_bandwidth](size_t lp_id) {
-                               return solution_.lightpaths_[lp_id].unused_bandwidth < lightpath_bandwidth;
-                           });
-    };
-    auto is_simple = [this](const std::vector<size_t> &path) {
-        std::unordered_set<size_t> nodes;
-        if (!path.empty()) {
-            nodes.insert(solution_.lightpaths_[path[0]].nodes[0]);
-        }
-        for (size_t lp_id: path) {
-            for (size_t i = 1; i < solution_.lightpaths_[lp_id].nodes.size(); ++i) {
-                if (!nodes.insert(solution_.lightpaths_[lp_id].nodes[i]).second) {
-                    return false;
+    ValidationFailure failure;
+    return Validate(failure);
+}
+
+bool Validator::Validate(ValidationFailure &failure) const {
+    failure = ValidationFailure();
+
+    // Workers take chunks of demands until all are checked or any of them finds a violation. Among the violations
+    // found before everyone stopped, the one of the smallest demand is reported
+    std::vector<Scratch> scratches(workers_number_);
+    std::atomic<size_t> next_chunk(0);
+    std::atomic<bool> is_failed(false);
+    std::mutex failure_mutex;
+    auto work = [&](size_t worker) {
+        Scratch &scratch = scratches[worker];
+        scratch.path_mask.assign(NodeMaskWords(n_), 0);
+        scratch.loads.assign(l_, 0);
+        scratch.uses.assign(l_, 0);
+        for (size_t chunk = next_chunk++; chunk * kChunkSize < m_; chunk = next_chunk++) {
+            for (size_t demand_id = chunk * kChunkSize; demand_id < std::min(m_, (chunk + 1) * kChunkSize);
+                 ++demand_id) {
+                if (is_failed.load(std::memory_order_relaxed)) {
+                    return;
+                }
+
+                size_t lp_id = SIZE_MAX;
+                Violation violation = CheckPath(demand_id, scratch, lp_id);
+                if (violation != Violation::kNone) {
+                    std::lock_guard<std::mutex> lock(failure_mutex);
+                    if (failure.violation == Violation::kNone || demand_id < failure.demand_id) {
+                        failure = {violation, demand_id, lp_id};
+                    }
+                    is_failed.store(true, std::memory_order_relaxed);
+                    return;
                 }
             }
         }
-
-        return true;
     };
 
+    std::vector<std::thread> workers;
+    for (size_t worker = 1; worker < workers_number_; ++worker) {
+        workers.emplace_back(work, worker);
+    }
+    work(0);
+    for (std::thread &worker: workers) {
+        worker.join();
+    }
+    if (is_failed) {
+        return false;
+    }
+
+    // The loads recomputed from the paths are the reference the residuals and the use marks are checked against
+    std::vector<size_t> &loads = scratches[0].loads;
+    std::vector<size_t> &uses = scratches[0].uses;
+    for (size_t worker = 1; worker < workers_number_; ++worker) {
+        for (size_t lp_id = 0; lp_id < l_; ++lp_id) {
+            loads[lp_id] += scratches[worker].loads[lp_id];
+            uses[lp_id] += scratches[worker].uses[lp_id];
+        }
+    }
+
     size_t lightpaths_number = 0;
-    for (size_t lp_id = 0; lp_id < solution_.lightpaths_.size(); ++lp_id) {
-        if (solution_.use_of_lightpaths[lp_id]) {
-            ++lightpaths_number;
+    for (size_t lp_id = 0; lp_id < l_; ++lp_id) {
+        Violation violation = Violation::kNone;
+        if (loads[lp_id] > lightpath_bandwidth_) {
+            violation = Violation::kOverloadedLightpath;
+        } else if (solution_.unused_bandwidth[lp_id] != lightpath_bandwidth_ - loads[lp_id]) {
+            violation = Violation::kWrongResidual;
+        } else if (solution_.use_of_lightpaths[lp_id] != (uses[lp_id] != 0)) {
+            violation = Violation::kWrongUse;
+        } else if (!HasLinks(lp_id)) {
+            violation = Violation::kMissingLink;
+        }
+        if (violation != Violation::kNone) {
+            failure = {violation, SIZE_MAX, lp_id};
+            return false;
         }
+        lightpaths_number += uses[lp_id] != 0;
     }
     if (solution_.lightpaths_number_ != lightpaths_number) {
+        failure.violation = Violation::kWrongLightpathsNumber;
         return false;
     }
 
-    for (size_t lp_id = 0; lp_id < solution_.lightpaths_.size(); ++lp_id) {
-        if (network_.GetDistance(solution_.lightpaths_[lp_id].nodes.front(),
-                                 solution_.lightpaths_[lp_id].nodes.back()) == (SIZE_MAX << 1)) {
+    return true;
+}
+
+Violation Validator::CheckPath(size_t demand_id, Scratch &scratch, size_t &lp_id) const {
+    if (demand_id >= solution_.demand_lightpaths.size() || solution_.demand_lightpaths[demand_id].empty()) {
+        return Violation::kMissingPath;
+    }
+
+    // The path is walked node by node, and every lightpath may be traversed in either direction
+    const TrafficDemand &demand = demands_[demand_id];
+    uint64_t *path_mask = scratch.path_mask.data();
+    std::fill(scratch.path_mask.begin(), scratch.path_mask.end(), 0);
+    SetNode(path_mask, demand.source);
+    size_t node = demand.source;
+    Violation violation = Violation::kNone;
+    for (size_t path_lp_id: solution_.demand_lightpaths[demand_id]) {
+        lp_id = path_lp_id;
+        if (lp_id >= l_) {
+            return Violation::kUnknownLightpath;
+        }
+
+        const Lightpath &lightpath = solution_.lightpaths_[lp_id];
+        if (lightpath.nodes_number == 0 || (lightpath.source != node && lightpath.destination != node)) {
+            return Violation::kDisconnectedPath;
+        }
+        const size_t *nodes = solution_.LightpathNodes(lp_id);
+        for (size_t i = 0; i < lightpath.nodes_number; ++i) {
+            if (nodes[i] != node && HasNode(path_mask, nodes[i])) {
+                violation = Violation::kNotSimplePath;
+            }
+            SetNode(path_mask, nodes[i]);
+        }
+        if (violation != Violation::kNone) {
+            return violation;
+        }
+        node = lightpath.source == node ? lightpath.destination : lightpath.source;
+
+        scratch.loads[lp_id] += demand.bandwidth;
+        ++scratch.uses[lp_id];
+    }
+    if (node != demand.destination) {
+        return Violation::kDisconnectedPath;
+    }
+
+    lp_id = SIZE_MAX;
+    return Violation::kNone;
+}
+
+bool Validator::HasLinks(size_t lp_id) const {
+    const size_t *nodes = solution_.LightpathNodes(lp_id);
+    for (size_t i = 1; i < solution_.lightpaths_[lp_id].nodes_number; ++i) {
+        if (!network_.HasLink(nodes[i - 1], nodes[i])) {
             return false;
         }
     }
+    return true;
+}
 
-    for (const TrafficDemand &demand: demands_) {
-        std::vector<size_t> path(solution_.demand_lightpaths.at(&demand));
-        if (path.empty() || !is_not_overused(path, lightpath_bandwidth_) || !is_simple(path)) {
+bool Validator::IsSimple(const std::vector<size_t> &path) const {
+    // A policy per call, since the chunks of a validation check their paths concurrently
+    SimplePathPolicy simple_path(solution_);
+    for (size_t lp_id: path) {
+        if (!simple_path.Push(lp_id, 0)) {
             return false;
         }
     }
@@ -0,0 +1,73 @@
+#include "headers/worker_pool.h"
+
+#include <algorithm>
+
+WorkerPool::WorkerPool(size_t workers_number) {
+    for (size_t worker = 1; worker < workers_number; ++worker) {
+        threads_.emplace_back(&WorkerPool::Work, this, worker);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        is_stopping_ = true;
+    }
+    batch_started_.notify_all();
+    for (std::thread &thread: threads_) {
+        thread.join();
+    }
+}
+
+size_t WorkerPool::GetWorkersNumber() const {
+    return threads_.size() + 1;
+}
+
+void WorkerPool::Run(size_t tasks_number, const std::function<void(size_t)> &task) {
+    tasks_number = std::min(tasks_number, GetWorkersNumber());
+    if (tasks_number == 0) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        task_ = &task;
+        tasks_number_ = tasks_number;
+        pending_tasks_number_ = tasks_number - 1;
+        ++batch_number_;
+    }
+    if (tasks_number > 1) {
+        batch_started_.notify_all();
+    }
+
+    task(0);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    batch_finished_.wait(lock, [this]() {
+        return pending_tasks_number_ == 0;
+    });
+}
+
+void WorkerPool::Work(size_t worker) {
+    size_t seen_batch_number = 0;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        batch_started_.wait(lock, [this, seen_batch_number]() {
+            return is_stopping_ || batch_number_ != seen_batch_number;
+        });
+        if (is_stopping_) {
+            return;
+        }
+        seen_batch_number = batch_number_;
+        if (worker >= tasks_number_) {
+            continue;
+        }
+
+        lock.unlock();
+        (*task_)(worker);
+        lock.lock();
+        if (--pending_tasks_number_ == 0) {
+            batch_finished_.notify_one();
+        }
+    }
+}